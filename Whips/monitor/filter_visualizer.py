@@ -95,13 +95,14 @@ class Visualizer(DeviceMonitorFilterBase):
             hex_bytes = ' '.join(f'{ord(c):02X}' for c in content)
             return f"Visualize: (too short) {hex_bytes}"
 
-        # Skip checksum (bytes 0-1), get command (byte 2) and whip (byte 3)
+        # Skip checksum (bytes 0-1), get command (byte 2) and whip (byte 3);
+        # bytes 4-5 are the presentation deadline
         command = content[2]
         whip = ord(content[3])
         whip_str = 'ALL' if whip == 255 else str(whip)
 
-        # Parse command-specific parameters (starting at byte 4)
-        params = content[4:]
+        # Parse command-specific parameters (starting at byte 6)
+        params = content[6:]
 
         if command == 'c':  # Set Whip Color - CRGB (3 bytes: R, G, B)
             if len(params) >= 3:
@@ -143,6 +144,18 @@ class Visualizer(DeviceMonitorFilterBase):
                 return ""  # Shown in visualizer window
             return f"Visualize: Set Brightness (Whip: {whip_str}, Brightness: ?)"
 
+        elif command == 'd':  # Fade Brightness - uint8_t brightness, uint16_t fadeMillis
+            if len(params) >= 1:
+                # the display jumps straight to the level the whips fade to
+                brightness = ord(params[0])
+                self._send_command({
+                    'type': 'set_brightness',
+                    'whip': whip,
+                    'brightness': brightness
+                })
+                return ""  # Shown in visualizer window
+            return f"Visualize: Fade Brightness (Whip: {whip_str}, Brightness: ?)"
+
         elif command == 'i':  # Self Identify - no extra params
             # Update the graphical display
             self._send_command({
@@ -0,0 +1,68 @@
+#pragma once
+
+/*
+ * Interface between the bus simulator (host) and one simulated Teensy.
+ *
+ * The native build turns the firmware into a shared library. The simulator
+ * loads a private copy of it per board, so every DOM and SUB gets its own
+ * globals, and talks to each copy only through these C entry points.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SIM_BOARD_API_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Callbacks from a board into the host
+struct SimHostApi
+{
+    void *host;
+    int board; // host's index for this board
+
+    uint64_t (*micros)(void *host, int board);                      // board's local clock
+    void (*stall)(void *host, int board, uint32_t us);               // board is busy for this long (delay, busy-wait)
+    void (*uartWrite)(void *host, int board, const uint8_t *buf, size_t cb); // Serial1 TX
+    void (*ledShow)(void *host, int board, const uint8_t *rgb, size_t cb, uint32_t frameTag); // strip output, RGB
+    void (*debugWrite)(void *host, int board, const char *buf, size_t cb); // USB Serial
+};
+
+struct SimBoardConfig
+{
+    bool dom;               // pinGndMeansDom grounded
+    uint8_t whip;           // DIP switch setting
+    const char *sdRoot;     // host directory standing in for the SD card
+    uint16_t rxBufferSize;  // Serial1 receive buffer in bytes
+};
+
+struct SimBoardStats
+{
+    uint32_t rxBytes;    // bytes accepted into the Serial1 receive buffer
+    uint32_t rxOverflow; // bytes dropped because the receive buffer was full
+};
+
+int sim_board_version();
+
+// Runs the firmware's setup()
+void sim_board_begin(const SimHostApi *api, const SimBoardConfig *config);
+
+// Runs one pass of the firmware's loop()
+void sim_board_loop();
+
+// Bytes arriving on Serial1 RX. tags[i] is the host's frame number for
+// buf[i]; it is reported back with the next show. Returns how many bytes
+// fit in the receive buffer; the rest are lost.
+size_t sim_board_uart_receive(const uint8_t *buf, const uint32_t *tags, size_t cb);
+
+// DOM inputs
+void sim_board_ir(int op);
+void sim_board_button();
+
+void sim_board_stats(SimBoardStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,689 @@
+/*
+ * whipsim - runs the DOM and all 24 SUBs in one Linux process.
+ *
+ * Each board is a private copy of the native firmware build
+ * (libWhipsBoard.so), so every board has its own globals. The boards are
+ * connected by a model of the daisy-chained Serial1 bus: the DOM's bytes
+ * go out at the configured baud rate (10 bits per byte), PacketSerial's
+ * COBS packet markers delimit frames, and each hop down the chain adds a
+ * fixed delay. Every SUB has a Teensy-sized receive buffer that overflows
+ * while its firmware is busy.
+ *
+ * Time is simulated. A board's clock only moves when the simulator ticks,
+ * when the firmware stalls (delay(), waiting on the strip), or by the host
+ * CPU time its code took, multiplied by --cpu-scale to approximate a
+ * 600 MHz Cortex-M7.
+ *
+ * Output (in --out):
+ *   trace.csv  time_us,board,event,frame,value
+ *              frame  DOM finished sending a frame  (value = bytes)
+ *              show   SUB updated its strip         (value = latency in us since the DOM started sending that frame)
+ *              drop   SUB lost bytes to overflow    (value = bytes)
+ *              cpu    once per simulated second     (value = busy us in that second)
+ *              stall  once per simulated second     (value = stalled us in that second)
+ *   frames.bin every strip update: uint64 time_us, uint8 whip, uint16 bytes, RGB bytes
+ *   final.ppm  the last frame of every whip, one column per whip
+ */
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "SimBoard.h"
+
+#define SIM_MAX_WHIPS 24
+
+// Must match IR::Op in src/IR.h
+static const char *irOpNames[] = {
+    "noop", "next", "suggest", "red", "green", "blue", "white", "flash", "brighter", "dimmer"};
+
+struct Options
+{
+    std::string boardLib = "../.pio/build/native/libWhipsBoard.so";
+    std::string sdRoot = "../../Whips-Art/Hex/experiment";
+    std::string outDir = "out";
+    std::string script;
+    double seconds = 10;
+    int whips = SIM_MAX_WHIPS;
+    uint32_t baud = 2000000;
+    double hopMicros = 0.01; // ~2 m of cable per whip (see WHIP_HOP_MICROS)
+    uint16_t rxBuffer = 64;
+    uint16_t txBuffer = 64;
+    double cpuScale = 4.0;
+    double corruptRate = 0;
+    double clockPpm = 0;
+    uint32_t tickMicros = 10;
+    bool verbose = false;
+};
+
+struct BoardLib
+{
+    void *handle = nullptr;
+    int (*version)();
+    void (*begin)(const SimHostApi *, const SimBoardConfig *);
+    void (*loop)();
+    size_t (*uartReceive)(const uint8_t *, const uint32_t *, size_t);
+    void (*ir)(int);
+    void (*button)();
+    void (*stats)(SimBoardStats *);
+};
+
+struct WireByte
+{
+    uint8_t value;
+    uint32_t frame;
+    double endMicros; // when the stop bit leaves the DOM
+};
+
+struct WireFrame
+{
+    double startMicros;
+    double endMicros;
+    uint32_t bytes;
+};
+
+struct Board
+{
+    BoardLib lib;
+    SimHostApi api;
+    SimBoardConfig config;
+    std::string name;
+
+    uint64_t time = 0;       // local clock, us
+    double clockPpm = 0;     // how fast micros() runs compared to it
+    uint64_t cpuCarryNs = 0; // scaled CPU time not yet added to the clock
+
+    size_t busCursor = 0; // next wire byte to deliver (SUBs)
+
+    // stats
+    uint64_t cpuNs = 0;
+    uint64_t windowCpuNs = 0;
+    uint64_t stallMicros = 0;
+    uint64_t windowStallMicros = 0;
+    uint32_t shows = 0;
+    uint32_t framesSeen = 0;
+    uint32_t framesDamaged = 0;
+    uint32_t lastDamagedFrame = 0;
+    uint32_t bytesDropped = 0;
+    uint32_t bytesCorrupted = 0;
+    uint64_t latencySum = 0;
+    uint64_t latencyMax = 0;
+    uint32_t latencyCount = 0;
+    std::vector<uint8_t> lastFrame;
+    std::string debug; // USB serial output not yet printed
+};
+
+struct ScriptEvent
+{
+    uint64_t atMicros;
+    int irOp; // -1 = button
+};
+
+class Simulator
+{
+public:
+    explicit Simulator(const Options &opt) : opt(opt), rng(12345) {}
+
+    bool load();
+    void run();
+    void report();
+
+private:
+    static uint64_t hostMicros(void *host, int board);
+    static void hostStall(void *host, int board, uint32_t us);
+    static void hostUartWrite(void *host, int board, const uint8_t *buf, size_t cb);
+    static void hostLedShow(void *host, int board, const uint8_t *rgb, size_t cb, uint32_t frameTag);
+    static void hostDebugWrite(void *host, int board, const char *buf, size_t cb);
+
+    bool openBoard(Board &b, const std::string &path);
+    void step(Board &b);
+    void deliver(Board &sub, uint64_t now);
+    void damage(Board &sub, uint32_t frame);
+    void trace(uint64_t t, const Board &b, const char *event, uint32_t frame, uint64_t value);
+    void writePpm();
+
+    const Options &opt;
+    std::vector<Board> boards; // [0] = DOM, [1 + whip] = SUB
+    std::vector<ScriptEvent> script;
+    size_t scriptNext = 0;
+
+    std::vector<WireByte> wire;
+    size_t wireBase = 0; // index of wire[0] in the whole transmission
+    std::vector<WireFrame> frames;
+    double lineFreeMicros = 0;
+    double byteMicros = 5;
+
+    FILE *traceFile = nullptr;
+    FILE *framesFile = nullptr;
+    std::mt19937 rng;
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+};
+
+static uint64_t hostNanos()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+bool Simulator::openBoard(Board &b, const std::string &path)
+{
+    // dlopen() returns the same handle for the same file, so give every
+    // board its own copy of the library
+    char tmpl[] = "/tmp/whipsim-XXXXXX";
+    int fd = mkstemp(tmpl);
+    if (fd < 0)
+        return false;
+
+    FILE *src = fopen(path.c_str(), "rb");
+    if (!src)
+    {
+        fprintf(stderr, "whipsim: cannot open %s: %s\n", path.c_str(), strerror(errno));
+        close(fd);
+        unlink(tmpl);
+        return false;
+    }
+    char buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), src)) > 0)
+    {
+        if (write(fd, buf, n) != (ssize_t)n)
+            break;
+    }
+    fclose(src);
+    close(fd);
+
+    b.lib.handle = dlopen(tmpl, RTLD_NOW | RTLD_LOCAL);
+    unlink(tmpl);
+    if (!b.lib.handle)
+    {
+        fprintf(stderr, "whipsim: %s\n", dlerror());
+        return false;
+    }
+
+#define SIM_BIND(field, sym)                                                     \
+    *(void **)(&b.lib.field) = dlsym(b.lib.handle, sym);                         \
+    if (!b.lib.field)                                                            \
+    {                                                                            \
+        fprintf(stderr, "whipsim: %s missing from %s\n", sym, path.c_str());     \
+        return false;                                                            \
+    }
+    SIM_BIND(version, "sim_board_version");
+    SIM_BIND(begin, "sim_board_begin");
+    SIM_BIND(loop, "sim_board_loop");
+    SIM_BIND(uartReceive, "sim_board_uart_receive");
+    SIM_BIND(ir, "sim_board_ir");
+    SIM_BIND(button, "sim_board_button");
+    SIM_BIND(stats, "sim_board_stats");
+#undef SIM_BIND
+
+    if (b.lib.version() != SIM_BOARD_API_VERSION)
+    {
+        fprintf(stderr, "whipsim: %s has API version %d, expected %d\n", path.c_str(), b.lib.version(), SIM_BOARD_API_VERSION);
+        return false;
+    }
+    return true;
+}
+
+bool Simulator::load()
+{
+    byteMicros = 10.0 * 1e6 / opt.baud;
+
+    // Script: comma separated "ms:op", op is an IR op name or "button"
+    std::string s = opt.script;
+    size_t pos = 0;
+    while (pos < s.size())
+    {
+        size_t comma = s.find(',', pos);
+        std::string item = s.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        pos = (comma == std::string::npos) ? s.size() : comma + 1;
+
+        size_t colon = item.find(':');
+        if (colon == std::string::npos)
+        {
+            fprintf(stderr, "whipsim: bad script item '%s'\n", item.c_str());
+            return false;
+        }
+        ScriptEvent ev;
+        ev.atMicros = (uint64_t)(atof(item.substr(0, colon).c_str()) * 1000);
+        std::string op = item.substr(colon + 1);
+        ev.irOp = -2;
+        if (op == "button")
+            ev.irOp = -1;
+        for (int i = 0; i < (int)(sizeof(irOpNames) / sizeof(irOpNames[0])); i++)
+        {
+            if (op == irOpNames[i])
+                ev.irOp = i;
+        }
+        if (ev.irOp == -2)
+        {
+            fprintf(stderr, "whipsim: unknown op '%s'\n", op.c_str());
+            return false;
+        }
+        script.push_back(ev);
+    }
+    std::sort(script.begin(), script.end(), [](const ScriptEvent &a, const ScriptEvent &b)
+              { return a.atMicros < b.atMicros; });
+
+    mkdir(opt.outDir.c_str(), 0755);
+    traceFile = fopen((opt.outDir + "/trace.csv").c_str(), "w");
+    framesFile = fopen((opt.outDir + "/frames.bin").c_str(), "wb");
+    if (!traceFile || !framesFile)
+    {
+        fprintf(stderr, "whipsim: cannot write to %s\n", opt.outDir.c_str());
+        return false;
+    }
+    fprintf(traceFile, "time_us,board,event,frame,value\n");
+
+    boards.resize(1 + opt.whips);
+    for (size_t i = 0; i < boards.size(); i++)
+    {
+        Board &b = boards[i];
+        if (!openBoard(b, opt.boardLib))
+            return false;
+
+        b.api.host = this;
+        b.api.board = (int)i;
+        b.api.micros = hostMicros;
+        b.api.stall = hostStall;
+        b.api.uartWrite = hostUartWrite;
+        b.api.ledShow = hostLedShow;
+        b.api.debugWrite = hostDebugWrite;
+
+        b.config.dom = (i == 0);
+        b.config.whip = (i == 0) ? 0 : (uint8_t)(i - 1);
+        b.config.sdRoot = opt.sdRoot.c_str();
+        b.config.rxBufferSize = opt.rxBuffer;
+
+        // SUB crystals spread evenly from -clockPpm to +clockPpm
+        if (i > 0 && opt.whips > 1)
+            b.clockPpm = opt.clockPpm * (2.0 * (i - 1) / (opt.whips - 1) - 1.0);
+
+        char name[16];
+        snprintf(name, sizeof(name), i == 0 ? "dom" : "sub%02d", (int)i - 1);
+        b.name = name;
+    }
+
+    // setup() on every board, timing it like any other firmware code
+    for (Board &b : boards)
+    {
+        uint64_t t0 = hostNanos();
+        b.lib.begin(&b.api, &b.config);
+        b.cpuNs += hostNanos() - t0;
+    }
+    return true;
+}
+
+uint64_t Simulator::hostMicros(void *host, int board)
+{
+    Board &b = static_cast<Simulator *>(host)->boards[board];
+    return b.time + (int64_t)(b.time * b.clockPpm / 1e6);
+}
+
+void Simulator::hostStall(void *host, int board, uint32_t us)
+{
+    Board &b = static_cast<Simulator *>(host)->boards[board];
+    b.time += us;
+    b.stallMicros += us;
+    b.windowStallMicros += us;
+}
+
+void Simulator::hostUartWrite(void *host, int board, const uint8_t *buf, size_t cb)
+{
+    Simulator *sim = static_cast<Simulator *>(host);
+    if (board != 0)
+        return; // SUBs only listen
+
+    Board &dom = sim->boards[0];
+    double txWindow = sim->opt.txBuffer * sim->byteMicros;
+
+    for (size_t i = 0; i < cb; i++)
+    {
+        double start = std::max(sim->lineFreeMicros, (double)dom.time);
+
+        // Serial1.write() blocks once the TX buffer is full
+        if (start - dom.time > txWindow)
+        {
+            uint64_t unblocked = (uint64_t)(start - txWindow);
+            dom.stallMicros += unblocked - dom.time;
+            dom.windowStallMicros += unblocked - dom.time;
+            dom.time = unblocked;
+        }
+
+        if (sim->frames.empty() || sim->frames.back().endMicros != 0)
+            sim->frames.push_back({start, 0, 0});
+
+        uint32_t frame = (uint32_t)sim->frames.size(); // frames are numbered from 1
+        WireFrame &wf = sim->frames.back();
+        double end = start + sim->byteMicros;
+        sim->wire.push_back({buf[i], frame, end});
+        sim->lineFreeMicros = end;
+        wf.bytes++;
+
+        if (buf[i] == 0) // COBS packet marker
+        {
+            wf.endMicros = end;
+            sim->trace((uint64_t)end, dom, "frame", frame, wf.bytes);
+        }
+    }
+}
+
+void Simulator::hostLedShow(void *host, int board, const uint8_t *rgb, size_t cb, uint32_t frameTag)
+{
+    Simulator *sim = static_cast<Simulator *>(host);
+    Board &b = sim->boards[board];
+    if (board == 0)
+        return;
+
+    b.shows++;
+    b.lastFrame.assign(rgb, rgb + cb);
+
+    uint64_t latency = 0;
+    if (frameTag > 0 && frameTag <= sim->frames.size())
+    {
+        latency = b.time - (uint64_t)sim->frames[frameTag - 1].startMicros;
+        b.latencySum += latency;
+        b.latencyMax = std::max(b.latencyMax, latency);
+        b.latencyCount++;
+    }
+    sim->trace(b.time, b, "show", frameTag, latency);
+
+    uint64_t t = b.time;
+    uint8_t whip = b.config.whip;
+    uint16_t bytes = (uint16_t)cb;
+    fwrite(&t, sizeof(t), 1, sim->framesFile);
+    fwrite(&whip, sizeof(whip), 1, sim->framesFile);
+    fwrite(&bytes, sizeof(bytes), 1, sim->framesFile);
+    fwrite(rgb, 1, cb, sim->framesFile);
+}
+
+void Simulator::hostDebugWrite(void *host, int board, const char *buf, size_t cb)
+{
+    Simulator *sim = static_cast<Simulator *>(host);
+    if (!sim->opt.verbose)
+        return;
+
+    Board &b = sim->boards[board];
+    b.debug.append(buf, cb);
+
+    // dbgprintf sends D<length>{<message>}; anything else is printed by line
+    for (;;)
+    {
+        std::string msg;
+        size_t brace = b.debug.find('{');
+        if (b.debug.size() > 1 && b.debug[0] == 'D' && brace != std::string::npos &&
+            b.debug.find_first_not_of("0123456789", 1) == brace)
+        {
+            size_t len = strtoul(b.debug.c_str() + 1, nullptr, 10);
+            if (b.debug.size() < brace + len + 2)
+                return;
+            msg = b.debug.substr(brace + 1, len);
+            b.debug.erase(0, brace + len + 2);
+        }
+        else
+        {
+            size_t nl = b.debug.find('\n');
+            if (nl == std::string::npos || (b.debug[0] == 'D' && brace == std::string::npos))
+                return;
+            msg = b.debug.substr(0, nl + 1);
+            b.debug.erase(0, nl + 1);
+        }
+
+        while (!msg.empty() && (msg.back() == '\n' || msg.back() == '\r'))
+            msg.pop_back();
+        fprintf(stderr, "[%s %9.3f] %s\n", b.name.c_str(), b.time / 1e6, msg.c_str());
+    }
+}
+
+void Simulator::trace(uint64_t t, const Board &b, const char *event, uint32_t frame, uint64_t value)
+{
+    fprintf(traceFile, "%llu,%s,%s,%u,%llu\n", (unsigned long long)t, b.name.c_str(), event, frame, (unsigned long long)value);
+}
+
+void Simulator::damage(Board &sub, uint32_t frame)
+{
+    if (frame != sub.lastDamagedFrame)
+    {
+        sub.framesDamaged++;
+        sub.lastDamagedFrame = frame;
+    }
+}
+
+void Simulator::deliver(Board &sub, uint64_t now)
+{
+    double hop = opt.hopMicros * (sub.config.whip + 1);
+    size_t end = sub.busCursor;
+    while (end - wireBase < wire.size() && wire[end - wireBase].endMicros + hop <= now)
+        end++;
+    if (end == sub.busCursor)
+        return;
+
+    size_t cb = end - sub.busCursor;
+    std::vector<uint8_t> buf(cb);
+    std::vector<uint32_t> tags(cb);
+    for (size_t i = 0; i < cb; i++)
+    {
+        const WireByte &wb = wire[sub.busCursor + i - wireBase];
+        buf[i] = wb.value;
+        tags[i] = wb.frame;
+        if (wb.value == 0)
+            sub.framesSeen++;
+        if (opt.corruptRate > 0 && uniform(rng) < opt.corruptRate)
+        {
+            buf[i] ^= 1 << (rng() % 8);
+            sub.bytesCorrupted++;
+            damage(sub, wb.frame);
+        }
+    }
+
+    size_t accepted = sub.lib.uartReceive(buf.data(), tags.data(), cb);
+    if (accepted < cb)
+    {
+        sub.bytesDropped += cb - accepted;
+        for (size_t i = accepted; i < cb; i++)
+            damage(sub, tags[i]);
+        trace(now, sub, "drop", tags[accepted], cb - accepted);
+    }
+    sub.busCursor = end;
+}
+
+void Simulator::step(Board &b)
+{
+    uint64_t t0 = hostNanos();
+    b.lib.loop();
+    uint64_t dt = hostNanos() - t0;
+
+    b.cpuNs += dt;
+    b.windowCpuNs += dt;
+    b.cpuCarryNs += (uint64_t)(dt * opt.cpuScale);
+    b.time += b.cpuCarryNs / 1000;
+    b.cpuCarryNs %= 1000;
+}
+
+void Simulator::run()
+{
+    uint64_t endMicros = (uint64_t)(opt.seconds * 1e6);
+    uint64_t nextWindow = 1000000;
+
+    for (uint64_t now = 0; now < endMicros; now += opt.tickMicros)
+    {
+        while (scriptNext < script.size() && script[scriptNext].atMicros <= now)
+        {
+            const ScriptEvent &ev = script[scriptNext++];
+            if (ev.irOp < 0)
+                boards[0].lib.button();
+            else
+                boards[0].lib.ir(ev.irOp);
+        }
+
+        for (size_t i = 1; i < boards.size(); i++)
+            deliver(boards[i], now);
+
+        for (Board &b : boards)
+        {
+            if (b.time <= now)
+            {
+                b.time = now;
+                step(b);
+            }
+        }
+
+        if (now >= nextWindow)
+        {
+            for (Board &b : boards)
+            {
+                trace(now, b, "cpu", 0, (uint64_t)(b.windowCpuNs * opt.cpuScale / 1000));
+                trace(now, b, "stall", 0, b.windowStallMicros);
+                b.windowCpuNs = 0;
+                b.windowStallMicros = 0;
+            }
+            nextWindow += 1000000;
+
+            // Forget wire bytes every SUB has already received
+            size_t consumed = wireBase + wire.size();
+            for (size_t i = 1; i < boards.size(); i++)
+                consumed = std::min(consumed, boards[i].busCursor);
+            wire.erase(wire.begin(), wire.begin() + (consumed - wireBase));
+            wireBase = consumed;
+        }
+    }
+}
+
+void Simulator::writePpm()
+{
+    FILE *f = fopen((opt.outDir + "/final.ppm").c_str(), "wb");
+    if (!f)
+        return;
+
+    size_t height = 0;
+    for (size_t i = 1; i < boards.size(); i++)
+        height = std::max(height, boards[i].lastFrame.size() / 3);
+
+    // LED 0 is at the bottom of the whip
+    fprintf(f, "P6\n%d %d\n255\n", (int)boards.size() - 1, (int)height);
+    for (size_t row = height; row-- > 0;)
+    {
+        for (size_t i = 1; i < boards.size(); i++)
+        {
+            const std::vector<uint8_t> &px = boards[i].lastFrame;
+            uint8_t rgb[3] = {0, 0, 0};
+            if ((row + 1) * 3 <= px.size())
+                memcpy(rgb, &px[row * 3], 3);
+            fwrite(rgb, 1, 3, f);
+        }
+    }
+    fclose(f);
+}
+
+void Simulator::report()
+{
+    fclose(traceFile);
+    fclose(framesFile);
+    writePpm();
+
+    double seconds = opt.seconds;
+    uint64_t wireBytes = 0;
+    for (const WireFrame &wf : frames)
+        wireBytes += wf.bytes;
+
+    printf("%.1f s simulated, %zu frames / %llu bytes from the DOM, bus %.1f%% busy\n",
+           seconds, frames.size(), (unsigned long long)wireBytes,
+           100.0 * wireBytes * byteMicros / (seconds * 1e6));
+    printf("board   frames  damaged  dropped  shows   latency avg/max (us)   cpu%%   stalled%%\n");
+
+    for (Board &b : boards)
+    {
+        SimBoardStats stats;
+        b.lib.stats(&stats);
+        printf("%-6s %7u %8u %8u %6u %11.0f / %-8llu %6.2f %9.2f\n",
+               b.name.c_str(),
+               b.framesSeen, b.framesDamaged, stats.rxOverflow, b.shows,
+               b.latencyCount ? (double)b.latencySum / b.latencyCount : 0.0,
+               (unsigned long long)b.latencyMax,
+               100.0 * b.cpuNs * opt.cpuScale / 1e9 / seconds,
+               100.0 * b.stallMicros / 1e6 / seconds);
+    }
+    printf("traces in %s/\n", opt.outDir.c_str());
+}
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: whipsim [options]\n"
+            "  --board PATH      native firmware library (default ../.pio/build/native/libWhipsBoard.so)\n"
+            "  --sd DIR          directory standing in for the SD card\n"
+            "  --out DIR         where to write trace.csv, frames.bin, final.ppm (default out)\n"
+            "  --seconds N       simulated time (default 10)\n"
+            "  --whips N         number of SUBs (default 24)\n"
+            "  --baud N          bus speed (default 2000000)\n"
+            "  --hop-us F        delay added by each hop down the chain (default 0.01)\n"
+            "  --rx-buffer N     SUB Serial1 receive buffer bytes (default 64)\n"
+            "  --tx-buffer N     DOM Serial1 transmit buffer bytes (default 64)\n"
+            "  --cpu-scale F     Teensy time per unit of host CPU time (default 4)\n"
+            "  --corrupt P       probability of flipping a bit in each received byte\n"
+            "  --clock-ppm F     SUB clock error, spread from -F to +F ppm (default 0)\n"
+            "  --script LIST     DOM inputs, e.g. 500:button,1000:button,8000:next\n"
+            "                    ops: button noop next suggest red green blue white flash brighter dimmer\n"
+            "  --verbose         print every board's debug output\n");
+}
+
+int main(int argc, char **argv)
+{
+    Options opt;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--verbose")
+            opt.verbose = true;
+        else if (arg == "--board" && hasValue)
+            opt.boardLib = argv[++i];
+        else if (arg == "--sd" && hasValue)
+            opt.sdRoot = argv[++i];
+        else if (arg == "--out" && hasValue)
+            opt.outDir = argv[++i];
+        else if (arg == "--seconds" && hasValue)
+            opt.seconds = atof(argv[++i]);
+        else if (arg == "--whips" && hasValue)
+            opt.whips = std::min(SIM_MAX_WHIPS, std::max(1, atoi(argv[++i])));
+        else if (arg == "--baud" && hasValue)
+            opt.baud = (uint32_t)atol(argv[++i]);
+        else if (arg == "--hop-us" && hasValue)
+            opt.hopMicros = atof(argv[++i]);
+        else if (arg == "--rx-buffer" && hasValue)
+            opt.rxBuffer = (uint16_t)atoi(argv[++i]);
+        else if (arg == "--tx-buffer" && hasValue)
+            opt.txBuffer = (uint16_t)atoi(argv[++i]);
+        else if (arg == "--cpu-scale" && hasValue)
+            opt.cpuScale = atof(argv[++i]);
+        else if (arg == "--corrupt" && hasValue)
+            opt.corruptRate = atof(argv[++i]);
+        else if (arg == "--clock-ppm" && hasValue)
+            opt.clockPpm = atof(argv[++i]);
+        else if (arg == "--script" && hasValue)
+            opt.script = argv[++i];
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    Simulator sim(opt);
+    if (!sim.load())
+        return 1;
+    sim.run();
+    sim.report();
+    return 0;
+}
@@ -0,0 +1,445 @@
+#include <Arduino.h>
+#include <SD.h>
+#include <EEPROM.h>
+#include <WS2812Serial.h>
+#include <FastLED.h>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <string>
+
+#include "SimCore.h"
+
+/*
+ * Native implementations of the Arduino core, SD, EEPROM and FastLED
+ * shims for one simulated board. Anything that takes time asks the host
+ * to stall this board instead of spinning.
+ */
+
+namespace SimCore
+{
+    const SimHostApi *api = nullptr;
+    SimBoardConfig config;
+
+    static uint8_t pinLevel[SIM_NUM_PINS];
+
+    void resetPins()
+    {
+        memset(pinLevel, 0xFF, sizeof(pinLevel)); // floating
+    }
+
+    void setPin(uint8_t pin, uint8_t level)
+    {
+        pinLevel[pin] = level;
+    }
+
+    void stall(uint32_t us)
+    {
+        if (api)
+            api->stall(api->host, api->board, us);
+    }
+}
+
+using namespace SimCore;
+
+SimUsbSerial Serial;
+SimUartSerial Serial1;
+SimEEPROM EEPROM;
+SDClass SD;
+CFastLED FastLED;
+
+//
+// Time and pins
+//
+
+static uint64_t nowMicros()
+{
+    return api ? api->micros(api->host, api->board) : 0;
+}
+
+uint32_t millis()
+{
+    return (uint32_t)(nowMicros() / 1000);
+}
+
+uint32_t micros()
+{
+    return (uint32_t)nowMicros();
+}
+
+void delay(uint32_t ms)
+{
+    stall(ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    stall(us);
+}
+
+void yield()
+{
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (mode == INPUT_PULLUP && pinLevel[pin] == 0xFF)
+        pinLevel[pin] = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    pinLevel[pin] = val ? HIGH : LOW;
+}
+
+uint8_t digitalRead(uint8_t pin)
+{
+    return pinLevel[pin] == LOW ? LOW : HIGH;
+}
+
+int analogRead(uint8_t)
+{
+    return 0;
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+//
+// Serial ports
+//
+
+size_t SimUsbSerial::write(const uint8_t *buf, size_t cb)
+{
+    if (api)
+        api->debugWrite(api->host, api->board, (const char *)buf, cb);
+    return cb;
+}
+
+size_t SimUartSerial::write(const uint8_t *buf, size_t cb)
+{
+    if (api)
+        api->uartWrite(api->host, api->board, buf, cb);
+    return cb;
+}
+
+void SimUartSerial::setRxBufferSize(uint16_t cb)
+{
+    delete[] rxBuffer;
+    delete[] rxTags;
+    rxBuffer = new uint8_t[cb];
+    rxTags = new uint32_t[cb];
+    rxSize = cb;
+    rxHead = rxCount = 0;
+}
+
+size_t SimUartSerial::receive(const uint8_t *buf, const uint32_t *tags, size_t cb)
+{
+    size_t accepted = 0;
+    while (accepted < cb && rxCount < rxSize)
+    {
+        uint16_t ix = (rxHead + rxCount) % rxSize;
+        rxBuffer[ix] = buf[accepted];
+        rxTags[ix] = tags[accepted];
+        rxCount++;
+        accepted++;
+    }
+    rxBytes += accepted;
+    rxOverflow += cb - accepted;
+    return accepted;
+}
+
+int SimUartSerial::read()
+{
+    if (rxCount == 0)
+        return -1;
+    uint8_t b = rxBuffer[rxHead];
+    if (b == 0)
+        frameTag = rxTags[rxHead]; // a COBS packet marker: this frame is complete
+    rxHead = (rxHead + 1) % rxSize;
+    rxCount--;
+    return b;
+}
+
+int SimUartSerial::peek()
+{
+    return rxCount ? rxBuffer[rxHead] : -1;
+}
+
+//
+// SD card
+//
+
+// Built-in SDIO card on a Teensy 4.1: roughly 20 MB/s sequential reads
+// and a fraction of a millisecond to open a file
+#define SIM_SD_BYTES_PER_US 20
+#define SIM_SD_OPEN_US 300
+
+struct SimFileImpl
+{
+    std::string path;
+    std::string name;
+    FILE *fp = nullptr;
+    DIR *dir = nullptr;
+
+    ~SimFileImpl()
+    {
+        if (fp)
+            fclose(fp);
+        if (dir)
+            closedir(dir);
+    }
+};
+
+void SDClass::setRoot(const char *dir)
+{
+    snprintf(root, sizeof(root), "%s", dir);
+}
+
+bool SDClass::begin(uint8_t)
+{
+    struct stat st;
+    return stat(root, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+File SDClass::open(const char *path, uint8_t mode)
+{
+    stall(SIM_SD_OPEN_US);
+
+    auto impl = std::make_shared<SimFileImpl>();
+    impl->path = std::string(root) + "/" + path;
+    const char *slash = strrchr(path, '/');
+    impl->name = slash ? slash + 1 : path;
+
+    struct stat st;
+    if (stat(impl->path.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+    {
+        impl->dir = opendir(impl->path.c_str());
+        return impl->dir ? File(impl) : File();
+    }
+
+    const char *fmode = "rb";
+    if (mode == FILE_WRITE)
+        fmode = (stat(impl->path.c_str(), &st) == 0) ? "r+b" : "w+b";
+    else if (mode == FILE_WRITE_BEGIN)
+        fmode = "w+b";
+
+    impl->fp = fopen(impl->path.c_str(), fmode);
+    if (!impl->fp)
+        return File();
+    if (mode == FILE_WRITE)
+        fseek(impl->fp, 0, SEEK_END);
+    return File(impl);
+}
+
+bool SDClass::exists(const char *path)
+{
+    struct stat st;
+    return stat((std::string(root) + "/" + path).c_str(), &st) == 0;
+}
+
+bool SDClass::remove(const char *path)
+{
+    return ::remove((std::string(root) + "/" + path).c_str()) == 0;
+}
+
+bool SDClass::mkdir(const char *path)
+{
+    return ::mkdir((std::string(root) + "/" + path).c_str(), 0755) == 0;
+}
+
+int File::read(void *buf, size_t cb)
+{
+    if (!impl || !impl->fp)
+        return -1;
+    int n = (int)fread(buf, 1, cb, impl->fp);
+    if (n > 0)
+        stall(n / SIM_SD_BYTES_PER_US);
+    return n;
+}
+
+int File::read()
+{
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int File::peek()
+{
+    if (!impl || !impl->fp)
+        return -1;
+    int c = fgetc(impl->fp);
+    if (c != EOF)
+        ungetc(c, impl->fp);
+    return c == EOF ? -1 : c;
+}
+
+int File::available()
+{
+    if (!impl || !impl->fp)
+        return 0;
+    uint64_t remaining = size() - position();
+    return remaining > 0x7FFFFFFF ? 0x7FFFFFFF : (int)remaining;
+}
+
+size_t File::write(const uint8_t *buf, size_t cb)
+{
+    if (!impl || !impl->fp)
+        return 0;
+    return fwrite(buf, 1, cb, impl->fp);
+}
+
+void File::flush()
+{
+    if (impl && impl->fp)
+        fflush(impl->fp);
+}
+
+bool File::seek(uint64_t pos)
+{
+    return impl && impl->fp && fseek(impl->fp, (long)pos, SEEK_SET) == 0;
+}
+
+uint64_t File::position()
+{
+    return (impl && impl->fp) ? (uint64_t)ftell(impl->fp) : 0;
+}
+
+uint64_t File::size()
+{
+    if (!impl || !impl->fp)
+        return 0;
+    struct stat st;
+    fflush(impl->fp);
+    return fstat(fileno(impl->fp), &st) == 0 ? (uint64_t)st.st_size : 0;
+}
+
+void File::close()
+{
+    impl.reset();
+}
+
+const char *File::name()
+{
+    return impl ? impl->name.c_str() : "";
+}
+
+bool File::isDirectory()
+{
+    return impl && impl->dir;
+}
+
+File File::openNextFile(uint8_t mode)
+{
+    if (!impl || !impl->dir)
+        return File();
+
+    struct dirent *entry;
+    while ((entry = readdir(impl->dir)) != nullptr)
+    {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+
+        std::string rel = impl->path.substr(strlen(SD.rootPath())) + "/" + entry->d_name;
+        return SD.open(rel.c_str(), mode);
+    }
+    return File();
+}
+
+void File::rewindDirectory()
+{
+    if (impl && impl->dir)
+        rewinddir(impl->dir);
+}
+
+//
+// FastLED
+//
+
+void CFastLED::show(uint8_t scale)
+{
+    output(leds, false, scale);
+}
+
+void CFastLED::showColor(const CRGB &color, uint8_t scale)
+{
+    output(&color, true, scale);
+}
+
+void CFastLED::clear(bool writeData)
+{
+    if (leds)
+        memset(leds, 0, numLeds * sizeof(CRGB));
+    if (writeData)
+        showColor(CRGB(0, 0, 0), 0);
+}
+
+void CFastLED::delay(unsigned long ms)
+{
+    // FastLED keeps refreshing the strip while it waits
+    uint32_t start = millis();
+    show();
+    uint32_t elapsed = millis() - start;
+    if (elapsed < ms)
+        ::delay(ms - elapsed);
+}
+
+bool CFastLED::refreshing()
+{
+    return lastShowMicros != 0 && micros() - lastShowMicros <= (uint32_t)(ledsPerStrip * 30 + 300);
+}
+
+// WS2812Serial.cpp isn't built natively; FastLED's output stands in for
+// it, and no strip ever begins, so instance() is always nullptr
+WS2812Serial *WS2812Serial::instances[8];
+uint8_t WS2812Serial::num_instances = 0;
+
+bool WS2812Serial::anyBusy()
+{
+    return FastLED.refreshing();
+}
+
+// FastLED's output here is never asynchronous: a frame waits only while
+// the strip is refreshing
+bool WS2812Serial::anyWaiting()
+{
+    return FastLED.refreshing();
+}
+
+void WS2812Serial::updateAll()
+{
+}
+
+// never called, as there is no instance() to cache frames for
+void WS2812Serial::showEncoded(const uint8_t *encoded)
+{
+    (void)encoded;
+}
+
+void CFastLED::output(const CRGB *pixels, bool solid, uint8_t scale)
+{
+    if (!pixels || numLeds == 0)
+        return;
+
+    // WS2812Serial::show(): 30us per LED of the longest strip plus 300us
+    // reset between frames
+    uint32_t minElapsed = ledsPerStrip * 30 + 300;
+    uint32_t elapsed = micros() - lastShowMicros;
+    if (lastShowMicros != 0 && elapsed <= minElapsed)
+        stall(minElapsed - elapsed + 1);
+    lastShowMicros = micros();
+
+    uint8_t rgb[numLeds * 3];
+    for (int i = 0; i < numLeds; i++)
+    {
+        const CRGB &c = solid ? pixels[0] : pixels[i];
+        rgb[i * 3 + 0] = scale8(c.r, scale);
+        rgb[i * 3 + 1] = scale8(c.g, scale);
+        rgb[i * 3 + 2] = scale8(c.b, scale);
+    }
+
+    if (api)
+        api->ledShow(api->host, api->board, rgb, numLeds * 3, Serial1.lastFrameTag());
+}
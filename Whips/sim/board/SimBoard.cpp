@@ -0,0 +1,69 @@
+#include <Arduino.h>
+#include <SD.h>
+
+#include "pins.h"
+#include "LedShow.h"
+#include "SimCore.h"
+
+/*
+ * C entry points the simulator calls on each board (see SimBoard.h).
+ * setup() and loop() are the firmware's own, from main.cpp.
+ */
+
+void setup();
+void loop();
+
+extern "C"
+{
+    int sim_board_version()
+    {
+        return SIM_BOARD_API_VERSION;
+    }
+
+    void sim_board_begin(const SimHostApi *api, const SimBoardConfig *config)
+    {
+        SimCore::api = api;
+        SimCore::config = *config;
+
+        // Board straps: DOM/SUB jumper and the 5 DIP switches (closed = LOW)
+        SimCore::resetPins();
+        SimCore::setPin(pinGndMeansDom, config->dom ? LOW : HIGH);
+        SimCore::setPin(pinDip16, (config->whip & 16) ? LOW : HIGH);
+        SimCore::setPin(pinDip8, (config->whip & 8) ? LOW : HIGH);
+        SimCore::setPin(pinDip4, (config->whip & 4) ? LOW : HIGH);
+        SimCore::setPin(pinDip2, (config->whip & 2) ? LOW : HIGH);
+        SimCore::setPin(pinDip1, (config->whip & 1) ? LOW : HIGH);
+        SimCore::setPin(pinButton, HIGH);
+
+        SD.setRoot(config->sdRoot);
+        Serial1.setRxBufferSize(config->rxBufferSize);
+
+        setup();
+    }
+
+    void sim_board_loop()
+    {
+        loop();
+    }
+
+    size_t sim_board_uart_receive(const uint8_t *buf, const uint32_t *tags, size_t cb)
+    {
+        return Serial1.receive(buf, tags, cb);
+    }
+
+    void sim_board_ir(int op)
+    {
+        SimCore::queueIROp(op);
+    }
+
+    void sim_board_button()
+    {
+        LedShow::onButtonPress();
+    }
+
+    void sim_board_stats(SimBoardStats *stats)
+    {
+        stats->rxBytes = Serial1.rxBytes;
+        stats->rxOverflow = Serial1.rxOverflow;
+    }
+}
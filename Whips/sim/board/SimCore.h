@@ -0,0 +1,19 @@
+#pragma once
+
+/*
+ * State shared by the native core pieces of one simulated board.
+ */
+
+#include "../SimBoard.h"
+
+namespace SimCore
+{
+    extern const SimHostApi *api;
+    extern SimBoardConfig config;
+
+    void resetPins();
+    void setPin(uint8_t pin, uint8_t level);
+    void stall(uint32_t us);
+    void queueIROp(int op);
+    int takeIROp(); // next queued IR op, or 0 (IR::noop)
+}
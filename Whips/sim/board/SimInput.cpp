@@ -0,0 +1,61 @@
+#include <Arduino.h>
+
+#include "Util.h"
+#include "IR.h"
+#include "Button.h"
+#include "LedShow.h"
+#include "SimCore.h"
+
+/*
+ * Native replacements for IR.cpp and Button.cpp. The simulator injects
+ * remote-control codes and button presses instead of real hardware.
+ */
+
+namespace SimCore
+{
+    static int irQueue[16];
+    static int irHead = 0, irCount = 0;
+
+    void queueIROp(int op)
+    {
+        if (irCount < (int)(sizeof(irQueue) / sizeof(irQueue[0])))
+        {
+            irQueue[(irHead + irCount) % 16] = op;
+            irCount++;
+        }
+    }
+
+    int takeIROp()
+    {
+        if (irCount == 0)
+            return IR::noop;
+        int op = irQueue[irHead];
+        irHead = (irHead + 1) % 16;
+        irCount--;
+        return op;
+    }
+}
+
+namespace IR
+{
+    void setup()
+    {
+        dbgprintf("IrReceiver ready (simulated)\n");
+    }
+
+    Op loop()
+    {
+        return (Op)SimCore::takeIROp();
+    }
+}
+
+namespace Button
+{
+    void setup()
+    {
+    }
+
+    void loop()
+    {
+    }
+}
@@ -0,0 +1,15 @@
+"""
+PlatformIO pre-script for the native environment.
+
+Links the firmware as a shared library (one simulated Teensy) that the
+bus simulator in sim/ loads once per board. Unit tests (pio test) keep
+the normal program build.
+"""
+Import("env")
+
+if "test" not in env.GetBuildType():
+    env.Append(
+        CCFLAGS=["-fPIC"],
+        LINKFLAGS=["-shared", "-Wl,-Bsymbolic"],
+    )
+    env.Replace(PROGNAME="libWhipsBoard", PROGSUFFIX=".so")
@@ -0,0 +1,157 @@
+#pragma once
+
+/*
+ * Minimal Arduino/Teensyduino core for the native (host) build.
+ * Only what the firmware and its host-portable libraries use.
+ * Time comes from the simulator, so millis() is simulated time.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+
+#define HIGH 1
+#define LOW 0
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define DEC 10
+#define HEX 16
+
+#define LED_BUILTIN 13
+#define A0 14
+#define BUILTIN_SDCARD 254
+
+#define SIM_NUM_PINS 256
+
+#define F(s) (s)
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+uint8_t digitalRead(uint8_t pin);
+#define digitalWriteFast digitalWrite
+#define digitalReadFast digitalRead
+int analogRead(uint8_t pin);
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+#ifdef __cplusplus
+#include <algorithm>
+using std::max;
+using std::min;
+
+template <typename T, typename L, typename H>
+T constrain(T x, L lo, H hi) { return x < (T)lo ? (T)lo : (x > (T)hi ? (T)hi : x); }
+#endif
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t *buf, size_t cb)
+    {
+        size_t n = 0;
+        while (cb--)
+            n += write(*buf++);
+        return n;
+    }
+    size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+
+    size_t print(const char *s) { return write(s); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int n, int base = DEC) { return print((long)n, base); }
+    size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(long n, int base = DEC) { return printf(base == HEX ? "%lX" : "%ld", n); }
+    size_t print(unsigned long n, int base = DEC) { return printf(base == HEX ? "%lX" : "%lu", n); }
+    size_t print(unsigned long long n, int base = DEC) { return printf(base == HEX ? "%llX" : "%llu", n); }
+    size_t print(double n, int digits = 2) { return printf("%.*f", digits, n); }
+
+    template <typename T>
+    size_t println(T v) { return print(v) + println(); }
+    template <typename T>
+    size_t println(T v, int base) { return print(v, base) + println(); }
+    size_t println() { return write("\r\n"); }
+
+    size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char buf[256];
+        va_list argv;
+        va_start(argv, fmt);
+        int n = vsnprintf(buf, sizeof(buf), fmt, argv);
+        va_end(argv);
+        if (n < 0)
+            return 0;
+        return write((const uint8_t *)buf, (size_t)n < sizeof(buf) ? n : sizeof(buf) - 1);
+    }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+};
+
+// USB serial: everything written goes to the simulator's debug output
+class SimUsbSerial : public Stream
+{
+public:
+    void begin(uint32_t) {}
+    operator bool() { return true; }
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *buf, size_t cb) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+};
+
+// Serial1: the DOM-to-SUB bus. RX is filled by the simulator's link model,
+// TX goes onto the simulated wire.
+class SimUartSerial : public Stream
+{
+public:
+    void begin(uint32_t baud) { this->baud = baud; }
+    operator bool() { return true; }
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *buf, size_t cb) override;
+    using Print::write;
+    int available() override { return rxCount; }
+    int read() override;
+    int peek() override;
+
+    // simulator side
+    void setRxBufferSize(uint16_t cb);
+    size_t receive(const uint8_t *buf, const uint32_t *tags, size_t cb);
+    uint32_t lastFrameTag() const { return frameTag; }
+
+    uint32_t baud = 0;
+    uint32_t rxBytes = 0;
+    uint32_t rxOverflow = 0;
+
+private:
+    uint8_t *rxBuffer = nullptr;
+    uint32_t *rxTags = nullptr;
+    uint16_t rxSize = 0;
+    uint16_t rxHead = 0;
+    uint16_t rxCount = 0;
+    uint32_t frameTag = 0;
+};
+
+extern SimUsbSerial Serial;
+extern SimUartSerial Serial1;
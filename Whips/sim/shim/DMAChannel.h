@@ -0,0 +1,7 @@
+#pragma once
+
+// Native build: there is no DMA, this only lets WS2812Serial.h compile
+
+class DMAChannel
+{
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// Native build: a RAM-backed EEPROM that starts out erased (0xFF),
+// like a fresh Teensy 4.1
+
+class SimEEPROM
+{
+public:
+    SimEEPROM() { memset(data, 0xFF, sizeof(data)); }
+    uint8_t read(int addr) { return (addr >= 0 && addr < (int)sizeof(data)) ? data[addr] : 0xFF; }
+    void write(int addr, uint8_t value)
+    {
+        if (addr >= 0 && addr < (int)sizeof(data))
+            data[addr] = value;
+    }
+    void update(int addr, uint8_t value) { write(addr, value); }
+    uint16_t length() { return sizeof(data); }
+
+private:
+    uint8_t data[4284];
+};
+
+extern SimEEPROM EEPROM;
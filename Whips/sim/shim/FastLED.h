@@ -0,0 +1,157 @@
+#pragma once
+
+/*
+ * Native build stand-in for the parts of FastLED the firmware uses:
+ * CRGB, the global FastLED controller and the EVERY_N_* timers.
+ * show() hands the brightness-scaled pixels to the simulator instead of
+ * a WS2812Serial DMA transfer, after waiting out the strip refresh time
+ * the way WS2812Serial::show() does.
+ */
+
+#include <Arduino.h>
+
+typedef uint8_t fract8;
+
+// FastLED's scale8 with FASTLED_SCALE8_FIXED
+static inline uint8_t scale8(uint8_t i, fract8 scale)
+{
+    return (uint8_t)(((uint16_t)i * (1 + (uint16_t)scale)) >> 8);
+}
+
+struct CRGB
+{
+    union
+    {
+        struct
+        {
+            uint8_t r;
+            uint8_t g;
+            uint8_t b;
+        };
+        uint8_t raw[3];
+    };
+
+    typedef enum
+    {
+        Black = 0x000000,
+        Blue = 0x0000FF,
+        DarkOrange = 0xFF8C00,
+        Green = 0x008000,
+        Red = 0xFF0000,
+        White = 0xFFFFFF,
+    } HTMLColorCode;
+
+    CRGB() = default;
+    constexpr CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+    constexpr CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b(colorcode & 0xFF) {}
+    constexpr CRGB(HTMLColorCode colorcode) : CRGB((uint32_t)colorcode) {}
+
+    CRGB &operator=(HTMLColorCode colorcode)
+    {
+        *this = CRGB(colorcode);
+        return *this;
+    }
+    uint8_t &operator[](uint8_t x) { return raw[x]; }
+    const uint8_t &operator[](uint8_t x) const { return raw[x]; }
+};
+
+inline bool operator==(const CRGB &lhs, const CRGB &rhs) { return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b; }
+inline bool operator!=(const CRGB &lhs, const CRGB &rhs) { return !(lhs == rhs); }
+
+enum EOrder
+{
+    RGB = 0012,
+    RBG = 0021,
+    GRB = 0102,
+    GBR = 0120,
+    BRG = 0201,
+    BGR = 0210
+};
+
+#define DISABLE_DITHER 0x00
+#define BINARY_DITHER 0x01
+
+template <uint8_t DATA_PIN, EOrder RGB_ORDER>
+class WS2812SERIAL
+{
+};
+
+class CFastLED
+{
+public:
+    template <template <uint8_t DATA_PIN, EOrder RGB_ORDER> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+    CFastLED &addLeds(CRGB *data, int nLedsOrOffset, int nLedsIfOffset = 0)
+    {
+        // every strip is part of one array here; they're sent at the same
+        // time, so the longest sets the refresh time
+        int offset = nLedsIfOffset > 0 ? nLedsOrOffset : 0;
+        int count = nLedsIfOffset > 0 ? nLedsIfOffset : nLedsOrOffset;
+        leds = data;
+        if (offset + count > numLeds)
+            numLeds = offset + count;
+        if (count > ledsPerStrip)
+            ledsPerStrip = count;
+        return *this;
+    }
+
+    void setBrightness(uint8_t scale) { brightness = scale; }
+    void setDither(uint8_t) {} // never dithers
+    uint8_t getBrightness() { return brightness; }
+
+    void show() { show(brightness); }
+    void show(uint8_t scale);
+    void showColor(const CRGB &color) { showColor(color, brightness); }
+    void showColor(const CRGB &color, uint8_t scale);
+    void clear(bool writeData = false);
+    void delay(unsigned long ms);
+
+    int size() { return numLeds; }
+    CRGB *leds = nullptr;
+
+    // not FastLED: still sending or latching the last frame, which is what
+    // WS2812Serial::busy() reports on the Teensy
+    bool refreshing();
+
+private:
+    void output(const CRGB *pixels, bool solid, uint8_t scale);
+
+    int numLeds = 0;
+    int ledsPerStrip = 0;
+    uint8_t brightness = 255;
+    uint32_t lastShowMicros = 0;
+};
+
+extern CFastLED FastLED;
+
+// EVERY_N_* timers, same semantics as FastLED's CEveryNMillis
+class CEveryNMillis
+{
+public:
+    CEveryNMillis(uint32_t period) : period(period), prevTrigger(millis()) {}
+    uint32_t getTime() { return millis(); }
+    void setPeriod(uint32_t p) { period = p; }
+    uint32_t getPeriod() { return period; }
+    void reset() { prevTrigger = getTime(); }
+    bool ready()
+    {
+        bool isReady = (getTime() - prevTrigger) >= period;
+        if (isReady)
+            reset();
+        return isReady;
+    }
+    operator bool() { return ready(); }
+
+private:
+    uint32_t period;
+    uint32_t prevTrigger;
+};
+
+#define FASTLED_CONCAT_(a, b) a##b
+#define FASTLED_CONCAT(a, b) FASTLED_CONCAT_(a, b)
+
+#define EVERY_N_MILLIS_I(NAME, N) \
+    static CEveryNMillis NAME(N); \
+    if (NAME)
+#define EVERY_N_MILLIS(N) EVERY_N_MILLIS_I(FASTLED_CONCAT(PER, __COUNTER__), N)
+#define EVERY_N_MILLISECONDS(N) EVERY_N_MILLIS(N)
+#define EVERY_N_SECONDS(N) EVERY_N_MILLIS((N) * 1000UL)
@@ -0,0 +1,65 @@
+#pragma once
+
+/*
+ * Native build: the SD card is a directory on the host
+ * (see SimBoardConfig::sdRoot). Same File/SD surface as Teensy's SD library.
+ */
+
+#include <Arduino.h>
+#include <memory>
+
+#define FILE_READ 0
+#define FILE_WRITE 1
+#define FILE_WRITE_BEGIN 2
+
+struct SimFileImpl;
+
+class File : public Stream
+{
+public:
+    File() {}
+    explicit File(std::shared_ptr<SimFileImpl> impl) : impl(impl) {}
+
+    operator bool() const { return impl != nullptr; }
+
+    int read(void *buf, size_t cb);
+    int read() override;
+    int peek() override;
+    int available() override;
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *buf, size_t cb) override;
+    size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+    void flush() override;
+
+    bool seek(uint64_t pos);
+    uint64_t position();
+    uint64_t size();
+    void close();
+
+    const char *name();
+    bool isDirectory();
+    File openNextFile(uint8_t mode = FILE_READ);
+    void rewindDirectory();
+
+private:
+    std::shared_ptr<SimFileImpl> impl;
+};
+
+class SDClass
+{
+public:
+    bool begin(uint8_t csPin = BUILTIN_SDCARD);
+    File open(const char *path, uint8_t mode = FILE_READ);
+    bool exists(const char *path);
+    bool remove(const char *path);
+    bool mkdir(const char *path);
+
+    // simulator side
+    void setRoot(const char *root);
+    const char *rootPath() const { return root; }
+
+private:
+    char root[512] = ".";
+};
+
+extern SDClass SD;
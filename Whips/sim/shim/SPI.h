@@ -0,0 +1,3 @@
+#pragma once
+
+// Native build: nothing on the host needs SPI
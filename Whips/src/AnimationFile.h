@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Pre-sliced animation files (".whp")
+ *
+ * whipc (see whipc/) turns /NNN.gif into /NNN.whp on the SD card: the same
+ * animation, already decoded and cut into one strip per whip, so a SUB can
+ * load its frames with a single sequential read instead of LZW-decoding the
+ * whole 110x24 GIF to keep one scanline.
+ *
+ * Layout, all little-endian:
+ *
+ *   Header
+ *   uint16_t delay[cFrames]                       per-frame delay in ms
+ *   whip 0:  cFrames x cLeds x 3 bytes of RGB     frame 0 first, LED 0 first
+ *   whip 1:  ...
+ *   ...
+ *   whip cWhips - 1
+ *
+ * Pixel bytes are exactly what Gif::GIFDraw copies out of AnimatedGIF, so a
+ * .whp plays identically to the GIF it was made from.
+ */
+
+namespace AnimationFile
+{
+    const uint32_t MAGIC = 0x31504857; // "WHP1"
+    const uint16_t VERSION = 1;
+
+#pragma pack(push, 1)
+    struct Header
+    {
+        uint32_t magic;   // MAGIC
+        uint16_t version; // VERSION
+        uint16_t cWhips;  // scanlines in the source GIF (24)
+        uint16_t cLeds;   // LEDs per whip (GIF canvas width, 110)
+        uint16_t cFrames; // number of frames
+    };
+#pragma pack(pop)
+
+    inline bool IsValid(const Header &hdr)
+    {
+        return hdr.magic == MAGIC && hdr.version == VERSION &&
+               hdr.cWhips > 0 && hdr.cLeds > 0 && hdr.cFrames > 0;
+    }
+
+    inline uint32_t FrameBytes(const Header &hdr)
+    {
+        return (uint32_t)hdr.cLeds * 3;
+    }
+
+    // where the delay table starts
+    inline uint32_t DelayOffset(const Header &)
+    {
+        return sizeof(Header);
+    }
+
+    // where whip's block of frames starts
+    inline uint32_t WhipOffset(const Header &hdr, uint16_t whip)
+    {
+        return sizeof(Header) + (uint32_t)hdr.cFrames * sizeof(uint16_t) +
+               (uint32_t)whip * hdr.cFrames * FrameBytes(hdr);
+    }
+}
@@ -0,0 +1,242 @@
+#include <Arduino.h>
+#include <SD.h>
+
+#include "Util.h"
+#include "Gif.h"
+#include "Catalog.h"
+
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME 16777619u
+
+namespace Catalog
+{
+    Entry rgEntries[CATALOG_MAX_ENTRIES]; // sorted by ixGifNumber
+    uint16_t cEntries = 0;
+    uint16_t iCurrent = 0; // the entry Next() returned last
+
+    static uint32_t Fnv1a(uint32_t hash, const uint8_t *pb, size_t cb)
+    {
+        while (cb--)
+        {
+            hash ^= *pb++;
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    // the animation number in a name like "017.gif" or "017.whp", or 0 if
+    // it isn't one
+    static uint16_t ParseName(const char *name)
+    {
+        uint32_t n = 0;
+        const char *pch = name;
+        while (*pch >= '0' && *pch <= '9' && n <= 0xFFFF)
+            n = n * 10 + (*pch++ - '0');
+
+        if (pch == name || n > 0xFFFF)
+            return 0;
+        if (strcasecmp(pch, ".gif") != 0 && strcasecmp(pch, ".whp") != 0)
+            return 0;
+        return (uint16_t)n;
+    }
+
+    static void AddNumber(uint16_t *rgNumbers, uint16_t &cNumbers, uint16_t n)
+    {
+        // insertion sort, dropping the duplicate when both .gif and .whp exist
+        uint16_t i = cNumbers;
+        while (i > 0 && rgNumbers[i - 1] > n)
+            i--;
+        if (i > 0 && rgNumbers[i - 1] == n)
+            return;
+        if (cNumbers == CATALOG_MAX_ENTRIES)
+        {
+            dbgprintf("Catalog full, ignoring animation %d\n", n);
+            return;
+        }
+        memmove(&rgNumbers[i + 1], &rgNumbers[i], (cNumbers - i) * sizeof(uint16_t));
+        rgNumbers[i] = n;
+        cNumbers++;
+    }
+
+    // Lists the animation files in the root directory. The signature covers
+    // their names and sizes, added up so it doesn't depend on listing order.
+    static uint32_t ScanDirectory(uint16_t *rgNumbers, uint16_t &cNumbers)
+    {
+        uint32_t signature = 0;
+        cNumbers = 0;
+
+        File root = SD.open("/");
+        if (!root)
+            return 0;
+
+        while (true)
+        {
+            File entry = root.openNextFile();
+            if (!entry)
+                break;
+
+            const char *name = entry.name();
+            uint16_t n = entry.isDirectory() ? 0 : ParseName(name);
+            if (n != 0)
+            {
+                uint32_t size = (uint32_t)entry.size();
+                uint32_t hash = Fnv1a(FNV_OFFSET, (const uint8_t *)name, strlen(name));
+                signature += Fnv1a(hash, (const uint8_t *)&size, sizeof(size));
+                AddNumber(rgNumbers, cNumbers, n);
+            }
+            entry.close();
+        }
+        root.close();
+        return signature;
+    }
+
+    static bool ReadIndex(uint32_t dirSignature)
+    {
+        File f = SD.open(CATALOG_INDEX_FILE);
+        if (!f)
+            return false;
+
+        IndexHeader hdr;
+        bool fOk = f.read(&hdr, sizeof(hdr)) == sizeof(hdr) &&
+                   hdr.magic == MAGIC && hdr.version == VERSION &&
+                   hdr.dirSignature == dirSignature &&
+                   hdr.cEntries <= CATALOG_MAX_ENTRIES &&
+                   f.seek(hdr.offEntries) &&
+                   f.read(rgEntries, hdr.cEntries * sizeof(Entry)) == (int)(hdr.cEntries * sizeof(Entry));
+        f.close();
+
+        cEntries = fOk ? hdr.cEntries : 0;
+        return fOk;
+    }
+
+    // Opens every animation to fill in its entry, writing the index as it
+    // goes: the delay tables first, then the entries, then the header.
+    static void Rebuild(const uint16_t *rgNumbers, uint16_t cNumbers, uint32_t dirSignature)
+    {
+        static uint16_t rgDelays[MAX_FRAMES];
+        IndexHeader hdr;
+        hdr.magic = MAGIC;
+        hdr.version = VERSION;
+        hdr.cEntries = 0;
+        hdr.dirSignature = 0; // not valid until it's complete
+        hdr.offEntries = 0;
+
+        // FILE_WRITE appends, so start from nothing
+        SD.remove(CATALOG_INDEX_FILE);
+        File f = SD.open(CATALOG_INDEX_FILE, FILE_WRITE);
+        if (!f)
+            dbgprintf("Unable to write %s\n", CATALOG_INDEX_FILE);
+        else
+            f.write((const uint8_t *)&hdr, sizeof(hdr));
+        uint32_t offFile = sizeof(hdr);
+
+        cEntries = 0;
+        for (uint16_t i = 0; i < cNumbers; i++)
+        {
+            GIFINFO gi;
+            if (!Gif::GetGifInfo(rgNumbers[i], gi, rgDelays, MAX_FRAMES) || gi.iFrameCount == 0)
+            {
+                dbgprintf("Skipping animation %d: can't read it\n", rgNumbers[i]);
+                continue;
+            }
+
+            Entry &entry = rgEntries[cEntries++];
+            entry.ixGifNumber = rgNumbers[i];
+            entry.cFrames = (uint16_t)gi.iFrameCount;
+            entry.minDelay = (uint16_t)gi.iMinDelay;
+            entry.maxDelay = (uint16_t)gi.iMaxDelay;
+            entry.offDelays = offFile;
+
+            if (f)
+                f.write((const uint8_t *)rgDelays, entry.cFrames * sizeof(uint16_t));
+            offFile += entry.cFrames * sizeof(uint16_t);
+        }
+
+        if (f)
+        {
+            f.write((const uint8_t *)rgEntries, cEntries * sizeof(Entry));
+            hdr.cEntries = cEntries;
+            hdr.dirSignature = dirSignature;
+            hdr.offEntries = offFile;
+            f.seek(0);
+            f.write((const uint8_t *)&hdr, sizeof(hdr));
+            f.close();
+        }
+    }
+
+    void setup()
+    {
+        uint32_t timeStart = millis();
+        static uint16_t rgNumbers[CATALOG_MAX_ENTRIES];
+        uint16_t cNumbers;
+        uint32_t dirSignature = ScanDirectory(rgNumbers, cNumbers);
+
+        if (ReadIndex(dirSignature))
+        {
+            dbgprintf("Catalog: %d animations from %s\n", cEntries, CATALOG_INDEX_FILE);
+        }
+        else
+        {
+            Rebuild(rgNumbers, cNumbers, dirSignature);
+            dbgprintf("Catalog: rebuilt, %d animations\n", cEntries);
+        }
+        iCurrent = 0;
+        dbgprintf("Catalog took %d millis\n", millis() - timeStart);
+    }
+
+    const Entry *Next(uint16_t ixGifNumber)
+    {
+        if (cEntries == 0)
+            return nullptr;
+
+        // normally we're stepping on from the one returned last time
+        if (rgEntries[iCurrent].ixGifNumber != ixGifNumber)
+        {
+            // the first entry after ixGifNumber, less one
+            uint16_t lo = 0, hi = cEntries;
+            while (lo < hi)
+            {
+                uint16_t mid = (lo + hi) / 2;
+                if (rgEntries[mid].ixGifNumber <= ixGifNumber)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            iCurrent = lo == 0 ? cEntries - 1 : lo - 1;
+        }
+
+        iCurrent = (iCurrent + 1) % cEntries;
+        return &rgEntries[iCurrent];
+    }
+
+    const Entry *Find(uint16_t ixGifNumber)
+    {
+        uint16_t lo = 0, hi = cEntries;
+        while (lo < hi)
+        {
+            uint16_t mid = (lo + hi) / 2;
+            if (rgEntries[mid].ixGifNumber < ixGifNumber)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo < cEntries && rgEntries[lo].ixGifNumber == ixGifNumber ? &rgEntries[lo] : nullptr;
+    }
+
+    bool GetDelays(const Entry *pEntry, uint16_t *pDelays)
+    {
+        File f = SD.open(CATALOG_INDEX_FILE);
+        if (!f)
+            return false;
+
+        int cb = pEntry->cFrames * sizeof(uint16_t);
+        bool fOk = f.seek(pEntry->offDelays) && f.read(pDelays, cb) == cb;
+        f.close();
+        return fOk;
+    }
+
+    uint16_t Count()
+    {
+        return cEntries;
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Catalog of the animations on the SD card (DOM only)
+ *
+ * setup() lists the root directory once at boot. If the /NNN.gif and
+ * /NNN.whp files there are the same ones (names and sizes) recorded in
+ * /catalog.idx, the catalog is read back from it; otherwise every animation
+ * is opened once to get its frame count and delays, and the index is
+ * rewritten. After that, picking the next animation never touches the card;
+ * its per-frame delays are read from the index when it's about to be shown.
+ */
+
+#define CATALOG_MAX_ENTRIES 256
+#define CATALOG_INDEX_FILE "/catalog.idx"
+
+namespace Catalog
+{
+    const uint32_t MAGIC = 0x54414357; // "WCAT"
+    const uint16_t VERSION = 3;
+
+#pragma pack(push, 1)
+    struct Entry
+    {
+        uint16_t ixGifNumber;
+        uint16_t cFrames;   // at most MAX_FRAMES
+        uint16_t minDelay;  // ms
+        uint16_t maxDelay;  // ms
+        uint32_t offDelays; // where its uint16_t delay[cFrames] is in the index
+    };
+
+    // /catalog.idx is an IndexHeader, each animation's delay table, and then
+    // cEntries Entries
+    struct IndexHeader
+    {
+        uint32_t magic;        // MAGIC
+        uint16_t version;      // VERSION
+        uint16_t cEntries;
+        uint32_t dirSignature; // of the animation files it was built from
+        uint32_t offEntries;
+    };
+#pragma pack(pop)
+
+    void setup();
+
+    // the animation after ixGifNumber, wrapping around to the first one;
+    // nullptr if there are none
+    const Entry *Next(uint16_t ixGifNumber);
+
+    const Entry *Find(uint16_t ixGifNumber);
+
+    // reads pEntry->cFrames per-frame delays (ms) into pDelays. Returns
+    // false if the index can't be read.
+    bool GetDelays(const Entry *pEntry, uint16_t *pDelays);
+
+    uint16_t Count();
+}
@@ -0,0 +1,69 @@
+#include <string.h>
+
+#include "Checksum.h"
+
+// rgCrcTable[i] is the CRC of the byte i, for polynomial 0x8001
+static const uint16_t rgCrcTable[256] = {
+    0x0000, 0x8001, 0x8003, 0x0002, 0x8007, 0x0006, 0x0004, 0x8005,
+    0x800F, 0x000E, 0x000C, 0x800D, 0x0008, 0x8009, 0x800B, 0x000A,
+    0x801F, 0x001E, 0x001C, 0x801D, 0x0018, 0x8019, 0x801B, 0x001A,
+    0x0010, 0x8011, 0x8013, 0x0012, 0x8017, 0x0016, 0x0014, 0x8015,
+    0x803F, 0x003E, 0x003C, 0x803D, 0x0038, 0x8039, 0x803B, 0x003A,
+    0x0030, 0x8031, 0x8033, 0x0032, 0x8037, 0x0036, 0x0034, 0x8035,
+    0x0020, 0x8021, 0x8023, 0x0022, 0x8027, 0x0026, 0x0024, 0x8025,
+    0x802F, 0x002E, 0x002C, 0x802D, 0x0028, 0x8029, 0x802B, 0x002A,
+    0x807F, 0x007E, 0x007C, 0x807D, 0x0078, 0x8079, 0x807B, 0x007A,
+    0x0070, 0x8071, 0x8073, 0x0072, 0x8077, 0x0076, 0x0074, 0x8075,
+    0x0060, 0x8061, 0x8063, 0x0062, 0x8067, 0x0066, 0x0064, 0x8065,
+    0x806F, 0x006E, 0x006C, 0x806D, 0x0068, 0x8069, 0x806B, 0x006A,
+    0x0040, 0x8041, 0x8043, 0x0042, 0x8047, 0x0046, 0x0044, 0x8045,
+    0x804F, 0x004E, 0x004C, 0x804D, 0x0048, 0x8049, 0x804B, 0x004A,
+    0x805F, 0x005E, 0x005C, 0x805D, 0x0058, 0x8059, 0x805B, 0x005A,
+    0x0050, 0x8051, 0x8053, 0x0052, 0x8057, 0x0056, 0x0054, 0x8055,
+    0x80FF, 0x00FE, 0x00FC, 0x80FD, 0x00F8, 0x80F9, 0x80FB, 0x00FA,
+    0x00F0, 0x80F1, 0x80F3, 0x00F2, 0x80F7, 0x00F6, 0x00F4, 0x80F5,
+    0x00E0, 0x80E1, 0x80E3, 0x00E2, 0x80E7, 0x00E6, 0x00E4, 0x80E5,
+    0x80EF, 0x00EE, 0x00EC, 0x80ED, 0x00E8, 0x80E9, 0x80EB, 0x00EA,
+    0x00C0, 0x80C1, 0x80C3, 0x00C2, 0x80C7, 0x00C6, 0x00C4, 0x80C5,
+    0x80CF, 0x00CE, 0x00CC, 0x80CD, 0x00C8, 0x80C9, 0x80CB, 0x00CA,
+    0x80DF, 0x00DE, 0x00DC, 0x80DD, 0x00D8, 0x80D9, 0x80DB, 0x00DA,
+    0x00D0, 0x80D1, 0x80D3, 0x00D2, 0x80D7, 0x00D6, 0x00D4, 0x80D5,
+    0x0080, 0x8081, 0x8083, 0x0082, 0x8087, 0x0086, 0x0084, 0x8085,
+    0x808F, 0x008E, 0x008C, 0x808D, 0x0088, 0x8089, 0x808B, 0x008A,
+    0x809F, 0x009E, 0x009C, 0x809D, 0x0098, 0x8099, 0x809B, 0x009A,
+    0x0090, 0x8091, 0x8093, 0x0092, 0x8097, 0x0096, 0x0094, 0x8095,
+    0x80BF, 0x00BE, 0x00BC, 0x80BD, 0x00B8, 0x80B9, 0x80BB, 0x00BA,
+    0x00B0, 0x80B1, 0x80B3, 0x00B2, 0x80B7, 0x00B6, 0x00B4, 0x80B5,
+    0x00A0, 0x80A1, 0x80A3, 0x00A2, 0x80A7, 0x00A6, 0x00A4, 0x80A5,
+    0x80AF, 0x00AE, 0x00AC, 0x80AD, 0x00A8, 0x80A9, 0x80AB, 0x00AA,
+};
+
+namespace Checksum
+{
+    uint16_t Crc16(const uint8_t *pb, size_t cb, uint16_t crc)
+    {
+        while (cb--)
+            crc = (crc << 8) ^ rgCrcTable[(crc >> 8) ^ *pb++];
+        return crc;
+    }
+
+    // The two checksum bytes count as zeros, and leading zeros leave a CRC
+    // that starts from 0 at 0, so they can just be skipped.
+    static uint16_t PacketCrc(const uint8_t *pb, size_t cb)
+    {
+        return Crc16(pb + 2, cb - 2);
+    }
+
+    void Stamp(uint8_t *pb, size_t cb)
+    {
+        uint16_t crc = PacketCrc(pb, cb);
+        memcpy(pb, &crc, sizeof(crc));
+    }
+
+    bool Verify(const uint8_t *pb, size_t cb)
+    {
+        uint16_t checksum;
+        memcpy(&checksum, pb, sizeof(checksum));
+        return checksum == PacketCrc(pb, cb);
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Checksum computes the CRC16 every packet carries in its first two bytes:
+ * the same CRC as robtillaart/CRC's calcCRC16() (polynomial 0x8001, no
+ * reflection, start and final masks 0), a byte at a time from a 256 entry
+ * table instead of a bit at a time.
+ *
+ * The checksum is over the whole packet with its own two bytes taken as
+ * zero, so a packet can be verified where it lies, without clearing them.
+ */
+
+namespace Checksum
+{
+    // continues crc over cb bytes at pb
+    uint16_t Crc16(const uint8_t *pb, size_t cb, uint16_t crc = 0);
+
+    // fills in the checksum of a packet about to be sent
+    void Stamp(uint8_t *pb, size_t cb);
+
+    // true if the packet's checksum matches the rest of it (cb >= 2)
+    bool Verify(const uint8_t *pb, size_t cb);
+}
@@ -0,0 +1,95 @@
+#include <Arduino.h>
+#include <math.h>
+
+#include "DipSwitch.h"
+#include "ColorLut.h"
+
+#define COLORLUT_WHIPS 24
+
+namespace ColorLut
+{
+    // Each whip's red, green and blue out of 255, to match strips from
+    // different batches
+    const uint8_t rgTrim[COLORLUT_WHIPS][3] = {
+        {255, 255, 255}, // 0
+        {255, 255, 255}, // 1
+        {255, 255, 255}, // 2
+        {255, 255, 255}, // 3
+        {255, 255, 255}, // 4
+        {255, 255, 255}, // 5
+        {255, 255, 255}, // 6
+        {255, 255, 255}, // 7
+        {255, 255, 255}, // 8
+        {255, 255, 255}, // 9
+        {255, 255, 255}, // 10
+        {255, 255, 255}, // 11
+        {255, 255, 255}, // 12
+        {255, 255, 255}, // 13
+        {255, 255, 255}, // 14
+        {255, 255, 255}, // 15
+        {255, 255, 255}, // 16
+        {255, 255, 255}, // 17
+        {255, 255, 255}, // 18
+        {255, 255, 255}, // 19
+        {255, 255, 255}, // 20
+        {255, 255, 255}, // 21
+        {255, 255, 255}, // 22
+        {255, 255, 255}, // 23
+    };
+
+    uint16_t rgwGamma[256]; // light out at full brightness, 8.8
+    uint16_t rgwExact[3][256];
+    uint8_t rgbLut[3][256];
+    uint8_t brightnessLut = 0;
+    bool fBuilt = false;
+
+    static void Build(uint8_t brightness)
+    {
+        if (!fBuilt)
+        {
+            for (int v = 0; v < 256; v++)
+                rgwGamma[v] = (uint16_t)(powf(v / 255.0f, COLORLUT_GAMMA) * (255 * 256) + 0.5f);
+        }
+
+        uint8_t whip = DipSwitch::getWhipNumber();
+        for (int c = 0; c < 3; c++)
+        {
+            uint32_t scale = brightness * (whip < COLORLUT_WHIPS ? rgTrim[whip][c] : 255);
+            for (int v = 0; v < 256; v++)
+            {
+                // 255 * 256 * 255 * 255 still fits
+                uint16_t w = (rgwGamma[v] * scale + (255 * 255) / 2) / (255 * 255);
+                rgwExact[c][v] = w;
+                rgbLut[c][v] = min((w + 128) >> 8, 255);
+            }
+        }
+        brightnessLut = brightness;
+        fBuilt = true;
+    }
+
+    void SetBrightness(uint8_t brightness)
+    {
+        if (!fBuilt || brightness != brightnessLut)
+            Build(brightness);
+    }
+
+    uint8_t Brightness()
+    {
+        return brightnessLut;
+    }
+
+    void Apply(const CRGB *pledsContent, CRGB *pleds)
+    {
+        for (int i = 0; i < NUM_LEDS; i++)
+        {
+            pleds[i].r = rgbLut[0][pledsContent[i].r];
+            pleds[i].g = rgbLut[1][pledsContent[i].g];
+            pleds[i].b = rgbLut[2][pledsContent[i].b];
+        }
+    }
+
+    const uint16_t *Exact(uint8_t color)
+    {
+        return rgwExact[color];
+    }
+}
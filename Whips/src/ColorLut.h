@@ -0,0 +1,33 @@
+#pragma once
+
+#include <FastLED.h>
+
+/*
+ * ColorLut turns a content frame into what the strip should show in one
+ * pass: one lookup per color through a table that has gamma, brightness
+ * and this whip's color trim folded in. The tables are only worked out
+ * again when the brightness changes.
+ *
+ * GIFs and the other content are in sRGB, which the LEDs' linear response
+ * would show washed out, and brightness is a linear scale on top of the
+ * gamma curve, so dimming keeps the colors. Each color also has an 8.8
+ * fixed point table for Dither, which keeps the part the 8-bit one
+ * rounds off.
+ */
+
+// the LEDs' response to the content's values
+#define COLORLUT_GAMMA 2.2f
+
+namespace ColorLut
+{
+    // brightness 0-255, linear in light out; rebuilds the tables on a change
+    void SetBrightness(uint8_t brightness);
+    uint8_t Brightness();
+
+    // pleds from pledsContent; they may be the same frame
+    void Apply(const CRGB *pledsContent, CRGB *pleds);
+
+    // the light out for each value of color (0 red, 1 green, 2 blue) in
+    // 8.8 fixed point, up to 255.0
+    const uint16_t *Exact(uint8_t color);
+}
@@ -1,9 +1,7 @@
 #pragma once
 
-#include <PacketSerial.h>
-#include <CRC16.h>
-#include <CRC.h>
 #include "Util.h"
+#include "TxQueue.h"
 
 //
 // a bunch of data structures sent over the serial wire
@@ -11,14 +9,12 @@
 //
 
 // Here is a utility function that sends any command
-// as a packet over the PacketSerial driver.
+// as a packet through the DOM's transmit queue.
 template <typename T>
-void SendPacket(T *cmd, PacketSerial &packetSerial)
+void SendPacket(T *cmd, TxQueue::Priority pri)
 {
-    cmd->checksum = 0;
-    cmd->checksum = calcCRC16((uint8_t *)cmd, sizeof(T));
-    packetSerial.send((uint8_t *)cmd, sizeof(T));
-    visualize((uint8_t *)cmd, sizeof(T));
+    static_assert(sizeof(T) <= TXQUEUE_MAX_PACKET, "command too big for TxQueue; it would be dropped");
+    TxQueue::Send((uint8_t *)cmd, sizeof(T), pri);
 }
 
 // minimize byte size to maximize the throughput
@@ -29,11 +25,16 @@ struct cmdUnknown
 {
     cmdUnknown(char chCommand, uint8_t whip) : checksum(0),
                                                chCommand(chCommand),
-                                               whip(whip) {}
-
-    uint16_t checksum; // CRC16 checksum - will be filled in by SendPacket right before sending
-    char chCommand;    // command. Use 'c' for cmdSetWhipColor, for example
-    uint8_t whip;      // which whip should respond. 0 - 23 or 255 for all whips
+                                               whip(whip),
+                                               holdMicros(0) {}
+
+    uint16_t checksum;   // CRC16 checksum - will be filled in by SendPacket right before sending
+    char chCommand;      // command. Use 'c' for cmdSetWhipColor, for example
+    uint8_t whip;        // which whip should respond. 0 - 23 or 255 for all whips
+    uint16_t holdMicros; // presentation deadline: show the result this long after the
+                         // packet has left the DOM. Whips further down the chain get it
+                         // later and hold it for less (see DipSwitch::getHopMicros).
+                         // 0 shows it as soon as it arrives.
 };
 
 /* Set an entire whip to the same color */
@@ -61,6 +62,50 @@ struct cmdShowGIFFrame : cmdUnknown
     uint16_t iGifNumber; // We will look for a file named %03d.gif to display
 };
 
+/* Start loading the GIF that will be shown next, in the background.
+   Sent well ahead of the switch, and repeated until then. */
+struct cmdPrepareGIF : cmdUnknown
+{
+    cmdPrepareGIF(uint8_t whip, uint16_t iGifNumber) : cmdUnknown('p', whip),
+                                                       iGifNumber(iGifNumber)
+    {
+    }
+
+    uint16_t iGifNumber; // %03d.gif, as in cmdShowGIFFrame
+};
+
+/* Switch to a prepared GIF. From cmdShowGIFFrame number frame on, the DOM
+   sends iGifNumber; until then each whip makes sure it is fully loaded so
+   all of them change on that same frame. Repeated with every frame up to
+   the switch. */
+struct cmdCommitGIF : cmdUnknown
+{
+    cmdCommitGIF(uint8_t whip, uint32_t frame, uint16_t iGifNumber) : cmdUnknown('s', whip),
+                                                                      frame(frame),
+                                                                      iGifNumber(iGifNumber)
+    {
+    }
+
+    uint32_t frame;      // the first frame of the new GIF, in cmdShowGIFFrame's count
+    uint16_t iGifNumber;
+};
+
+/* Clock beacon for GIFs the whips play on their own (see Playback.h).
+   Sent as frame starts on the DOM, about once a second. */
+struct cmdGIFBeacon : cmdUnknown
+{
+    cmdGIFBeacon(uint8_t whip, uint32_t frame, uint16_t iGifNumber, uint32_t timeMicros) : cmdUnknown('t', whip),
+                                                                                         frame(frame),
+                                                                                         iGifNumber(iGifNumber),
+                                                                                         timeMicros(timeMicros)
+    {
+    }
+
+    uint32_t frame;      // in cmdShowGIFFrame's count
+    uint16_t iGifNumber;
+    uint32_t timeMicros; // DOM's micros() when frame started
+};
+
 /* Set Brightness */
 struct cmdSetBrightness : cmdUnknown
 {
@@ -72,6 +117,22 @@ struct cmdSetBrightness : cmdUnknown
     uint8_t brightness; // 0 (off) to 255 (blinding)
 };
 
+/* Fade to a brightness, each whip by its own clock from the presentation
+   deadline on. Sent when the brightness changes and now and again after,
+   in case a whip missed it or has rebooted; a whip that is already there,
+   or on its way there, carries on as it is. */
+struct cmdFadeBrightness : cmdUnknown
+{
+    cmdFadeBrightness(uint8_t whip, uint8_t brightness, uint16_t fadeMillis) : cmdUnknown('d', whip),
+                                                                              brightness(brightness),
+                                                                              fadeMillis(fadeMillis)
+    {
+    }
+
+    uint8_t brightness;  // as in cmdSetBrightness
+    uint16_t fadeMillis; // how long to take from the brightness now
+};
+
 /* ID yourself */
 struct cmdSelfIdentify : cmdUnknown
 {
@@ -4,6 +4,19 @@
 #include "DipSwitch.h"
 #include "pins.h"
 
+// How much later each whip down the daisy chain receives a byte than the
+// one before it. The chain is one RS-422 pair (Whips-PCB: a receive-only
+// MAX485E per whip, 120R at the end; Whips-Control-PCB drives it), so no
+// whip repeats the bytes and a hop is only the cable between two whips,
+// about 5 ns per metre of twisted pair: 0 us to the nearest microsecond.
+// The receivers' own delay is the same on every whip, so it doesn't put
+// one out of step with another. platformio.ini sets it for the Teensy
+// builds; an installation with repeaters between whips should measure it
+// (scope on Serial1 RX of the first and last whip) and set it there.
+#ifndef WHIP_HOP_MICROS
+#define WHIP_HOP_MICROS 0
+#endif
+
 uint8_t whip;
 
 namespace DipSwitch
@@ -32,6 +45,13 @@ namespace DipSwitch
         return whip;
     }
 
+    // how long after leaving the DOM a byte gets here; whips are chained
+    // in DIP-switch order
+    uint32_t getHopMicros()
+    {
+        return (whip + 1) * WHIP_HOP_MICROS;
+    }
+
     void readWhipNumber()
     {
         whip = (digitalReadFast(pinDip16) == HIGH ? 0 : 16) +
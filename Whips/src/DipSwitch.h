@@ -13,6 +13,7 @@ namespace DipSwitch
     void setup();
     void loop();
     uint8_t getWhipNumber();
+    uint32_t getHopMicros();
 
     void readWhipNumber();
 }
@@ -0,0 +1,41 @@
+#include <Arduino.h>
+
+#include "Dither.h"
+
+#define DITHER_COLORS (NUM_LEDS * 3)
+
+namespace Dither
+{
+    uint8_t rgbContent[DITHER_COLORS];
+    uint16_t rgwTarget[DITHER_COLORS]; // rgbContent through ColorLut at brightnessTarget
+    uint8_t rgbError[DITHER_COLORS];   // fraction carried to the next refresh
+    uint8_t brightnessTarget = 0;
+    bool fStale = true; // rgwTarget needs working out again
+
+    void SetFrame(const CRGB *pleds)
+    {
+        memcpy(rgbContent, pleds, sizeof(rgbContent));
+        fStale = true;
+    }
+
+    void Render(CRGB *pleds)
+    {
+        uint8_t brightness = ColorLut::Brightness();
+        if (fStale || brightness != brightnessTarget)
+        {
+            for (int i = 0; i < DITHER_COLORS; i++)
+                rgwTarget[i] = ColorLut::Exact(i % 3)[rgbContent[i]];
+            brightnessTarget = brightness;
+            fStale = false;
+        }
+
+        // at most 255 * 256 + 255, so never overflows
+        uint8_t *pb = (uint8_t *)pleds;
+        for (int i = 0; i < DITHER_COLORS; i++)
+        {
+            uint16_t w = rgwTarget[i] + rgbError[i];
+            pb[i] = w >> 8;
+            rgbError[i] = w & 0xFF;
+        }
+    }
+}
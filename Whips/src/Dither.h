@@ -0,0 +1,26 @@
+#pragma once
+
+#include <FastLED.h>
+
+#include "ColorLut.h"
+
+/*
+ * Dither spreads the part of each LED's brightness that 8 bits can't hold
+ * over the refreshes between content frames. At a low brightness most
+ * colors scale to the same handful of levels; a color that should be 1.4
+ * goes out as 1, 1, 2, 1, 2, ... instead, so over time each LED averages
+ * what it should be.
+ *
+ * SetFrame() takes the content; each Render() writes the next refresh of
+ * it through ColorLut, for FastLED.show(255). The frame as ColorLut's 8.8
+ * fixed point light out is kept along with each color's carried error.
+ */
+
+namespace Dither
+{
+    // the frame to dither toward from now on
+    void SetFrame(const CRGB *pleds);
+
+    // the next refresh of that frame at ColorLut's brightness, into pleds
+    void Render(CRGB *pleds);
+}
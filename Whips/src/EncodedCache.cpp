@@ -0,0 +1,94 @@
+#include <Arduino.h>
+
+#include "Util.h"
+#include "Gif.h"
+#include "EncodedCache.h"
+
+#if GIF_PREENCODED
+
+#define NO_OFFSET 0xFFFFFFFF
+
+namespace EncodedCache
+{
+    uint8_t *pPool = nullptr;
+    uint8_t *pHalf = nullptr; // the half of pPool in use
+    uint32_t cbUsed = 0;
+    uint32_t rgOffsets[MAX_FRAMES]; // by frame index, into pHalf
+
+    // what the frames in the pool are
+    uint16_t ixGif = 0;
+    uint8_t brightnessPool = 0;
+    bool fEmpty = true;
+
+    uint32_t cHits = 0;
+    uint32_t cMisses = 0;
+
+    static void Reset(uint16_t ixGifNumber, uint8_t brightness)
+    {
+        for (uint32_t i = 0; i < MAX_FRAMES; i++)
+            rgOffsets[i] = NO_OFFSET;
+        cbUsed = 0;
+        pHalf = (pHalf == pPool) ? pPool + ENCODEDCACHE_BYTES / 2 : pPool;
+        ixGif = ixGifNumber;
+        brightnessPool = brightness;
+        fEmpty = false;
+    }
+
+    static bool Matches(uint32_t key, uint8_t brightness)
+    {
+        return !fEmpty && GIF_FRAME_GIF(key) == ixGif && brightness == brightnessPool;
+    }
+
+    const uint8_t *Find(uint32_t key, uint8_t brightness)
+    {
+        if (key == GIF_NO_FRAME || GIF_FRAME_INDEX(key) >= MAX_FRAMES)
+            return nullptr;
+        if (!Matches(key, brightness) || rgOffsets[GIF_FRAME_INDEX(key)] == NO_OFFSET)
+        {
+            cMisses++;
+            return nullptr;
+        }
+        cHits++;
+        return pHalf + rgOffsets[GIF_FRAME_INDEX(key)];
+    }
+
+    uint8_t *Store(uint32_t key, uint8_t brightness, uint32_t cb)
+    {
+        if (key == GIF_NO_FRAME || GIF_FRAME_INDEX(key) >= MAX_FRAMES)
+            return nullptr;
+
+        if (!pPool)
+        {
+            pPool = (uint8_t *)malloc(ENCODEDCACHE_BYTES);
+            if (!pPool)
+            {
+                dbgprintf("No room for %d bytes of encoded frames\n", ENCODEDCACHE_BYTES);
+                return nullptr;
+            }
+        }
+
+        if (!Matches(key, brightness))
+            Reset(GIF_FRAME_GIF(key), brightness);
+
+        // words, so the DMA reads them fastest
+        uint32_t cbRounded = (cb + 3) & ~3;
+        if (rgOffsets[GIF_FRAME_INDEX(key)] != NO_OFFSET || cbUsed + cbRounded > ENCODEDCACHE_BYTES / 2)
+            return nullptr;
+
+        rgOffsets[GIF_FRAME_INDEX(key)] = cbUsed;
+        cbUsed += cbRounded;
+        return pHalf + rgOffsets[GIF_FRAME_INDEX(key)];
+    }
+
+    uint32_t Hits()
+    {
+        return cHits;
+    }
+
+    uint32_t Misses()
+    {
+        return cMisses;
+    }
+}
+
+#endif // GIF_PREENCODED
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * EncodedCache keeps the GIF frames a SUB has shown in WS2812Serial's wire
+ * format (12 UART bytes per LED), so showing one again is just pointing the
+ * strip's DMA at it: no copy into leds, no brightness scaling, no bit
+ * expansion. Only with GIF_PREENCODED.
+ *
+ * A frame is captured from the strips' frame buffers, one after another,
+ * the first time it goes out the ordinary way, so it has exactly the brightness and color order
+ * FastLED gave it. GIF frames never change once loaded; the cache only
+ * empties when the brightness changes, or for a different GIF.
+ *
+ * The frames share a pool of ENCODEDCACHE_BYTES taken from the heap the
+ * first time; frames that don't fit just go out the ordinary way. Each
+ * time it empties it fills the other half of the pool, because a strip's
+ * DMA may still be reading a frame from before. That can only be from the
+ * time before, since Led sends nothing while a frame is waiting for the
+ * strip.
+ */
+
+#ifndef GIF_PREENCODED
+#define GIF_PREENCODED 0
+#endif
+
+#ifndef ENCODEDCACHE_BYTES
+#define ENCODEDCACHE_BYTES (128 * 1024)
+#endif
+
+namespace EncodedCache
+{
+    // the encoded frame for key (from Gif::GetFrame) at this brightness,
+    // or nullptr
+    const uint8_t *Find(uint32_t key, uint8_t brightness);
+
+    // room to keep cb bytes of encoded frame for key, for the caller to
+    // fill, or nullptr
+    uint8_t *Store(uint32_t key, uint8_t brightness, uint32_t cb);
+
+    uint32_t Hits();
+    uint32_t Misses();
+}
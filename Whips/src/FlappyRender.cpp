@@ -3,7 +3,7 @@
 
 // 5x7 digit font for score display (each digit is 5 pixels wide, 7 tall)
 // Each row is stored as 5 bits (MSB on left)
-static const uint8_t digitFont[10][7] = {
+const uint8_t flappyDigitFont[10][7] = {
     {0b01110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110}, // 0
     {0b00100, 0b01100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110}, // 1
     {0b01110, 0b10001, 0b00001, 0b00110, 0b01000, 0b10000, 0b11111}, // 2
@@ -20,6 +20,18 @@ static const uint8_t digitFont[10][7] = {
 #define FONT_WIDTH 5
 #define FONT_HEIGHT 7
 
+// Score digits scaled to be 3/4 of screen height
+// Y scale: 47 -> 329 virtual pixels tall (~82 physical LEDs, 3/4 of screen)
+// X scale: 3 -> 15 virtual pixels wide (~4 physical pixels)
+#define SCORE_SCALE_X 3
+#define SCORE_SCALE_Y 47
+#define SCORE_DIGIT_WIDTH (FONT_WIDTH * SCORE_SCALE_X)      // 15 virtual pixels
+#define SCORE_DIGIT_HEIGHT (FONT_HEIGHT * SCORE_SCALE_Y)    // 329 virtual pixels
+#define SCORE_DIGIT_SPACING (SCORE_DIGIT_WIDTH / 2)         // 7 virtual pixels (half-space between digits)
+#define SCORE_Y ((FLAPPY_VIRTUAL_HEIGHT - SCORE_DIGIT_HEIGHT) / 2) // Centered vertically
+#define SCORE_MAX_DIGITS 5                                  // uint16_t score
+#define SCORE_MAX_WIDTH (SCORE_MAX_DIGITS * SCORE_DIGIT_WIDTH + (SCORE_MAX_DIGITS - 1) * SCORE_DIGIT_SPACING)
+
 // Helper: clamp value to range
 static inline int clamp(int val, int minVal, int maxVal)
 {
@@ -67,74 +79,81 @@ static inline bool isGroundPixel(int vy)
     return (vy < FLAPPY_GROUND_HEIGHT);
 }
 
-// Helper: check if virtual pixel is part of score digit during gameover scroll
-static inline bool isScorePixel(int vx, int vy, uint16_t score, int16_t scrollX)
+// Score bitmap, rasterized once per score value into one entry per
+// virtual column. Bit k of an entry is set when font row k (0 = bottom)
+// is lit in that column; spacing columns are 0.
+static struct
 {
-    // Score digits scaled to be 3/4 of screen height
-    // Font is 5x7 pixels
-    // Y scale: 47 -> 329 virtual pixels tall (~82 physical LEDs, 3/4 of screen)
-    // X scale: 2.5 -> ~12 virtual pixels wide (~3 physical pixels)
-    const int SCALE_X = 3;
-    const int SCALE_Y = 47;
-    const int digitWidth = FONT_WIDTH * SCALE_X;                  // 10 virtual pixels
-    const int digitHeight = FONT_HEIGHT * SCALE_Y;                // 329 virtual pixels
-    const int digitSpacing = digitWidth / 2;                      // 5 virtual pixels (half-space between digits)
-    const int scoreY = (FLAPPY_VIRTUAL_HEIGHT - digitHeight) / 2; // Center vertically
-
-    // Convert score to digits
-    int digits[5];
-    int numDigits = 0;
-    int tempScore = score;
-    if (tempScore == 0)
-    {
-        digits[0] = 0;
-        numDigits = 1;
-    }
-    else
+    bool valid;
+    uint16_t score;
+    int width; // virtual columns used by this score
+    uint8_t columns[SCORE_MAX_WIDTH];
+} scoreGlyphs;
+
+// Helper: the column table for this score, rebuilt only when the score changes
+static const uint8_t *getScoreColumns(uint16_t score, int *width)
+{
+    if (!scoreGlyphs.valid || scoreGlyphs.score != score)
     {
-        while (tempScore > 0 && numDigits < 5)
+        // Convert score to digits, most significant first
+        int digits[SCORE_MAX_DIGITS];
+        int numDigits = 0;
+        int tempScore = score;
+        do
         {
             digits[numDigits++] = tempScore % 10;
             tempScore /= 10;
-        }
-        // Reverse
+        } while (tempScore > 0 && numDigits < SCORE_MAX_DIGITS);
+
         for (int i = 0; i < numDigits / 2; i++)
         {
             int tmp = digits[i];
             digits[i] = digits[numDigits - 1 - i];
             digits[numDigits - 1 - i] = tmp;
         }
-    }
 
-    int totalWidth = numDigits * digitWidth + (numDigits - 1) * digitSpacing;
+        scoreGlyphs.width = numDigits * SCORE_DIGIT_WIDTH + (numDigits - 1) * SCORE_DIGIT_SPACING;
+        memset(scoreGlyphs.columns, 0, sizeof(scoreGlyphs.columns));
 
-    // Position relative to scroll
-    int relX = vx - scrollX;
+        for (int d = 0; d < numDigits; d++)
+        {
+            for (int withinDigitX = 0; withinDigitX < SCORE_DIGIT_WIDTH; withinDigitX++)
+            {
+                int fontX = withinDigitX / SCORE_SCALE_X;
+                uint8_t bits = 0;
+                for (int fontY = 0; fontY < FONT_HEIGHT; fontY++)
+                {
+                    uint8_t row = flappyDigitFont[digits[d]][FONT_HEIGHT - 1 - fontY]; // Flip Y so 0 is bottom
+                    if ((row >> (FONT_WIDTH - 1 - fontX)) & 1)
+                        bits |= 1 << fontY;
+                }
+                scoreGlyphs.columns[d * (SCORE_DIGIT_WIDTH + SCORE_DIGIT_SPACING) + withinDigitX] = bits;
+            }
+        }
 
-    if (relX < 0 || relX >= totalWidth)
-        return false;
-    if (vy < scoreY || vy >= scoreY + digitHeight)
-        return false;
+        scoreGlyphs.score = score;
+        scoreGlyphs.valid = true;
+    }
 
-    // Which digit?
-    int digitIndex = relX / (digitWidth + digitSpacing);
-    if (digitIndex >= numDigits)
-        return false;
+    *width = scoreGlyphs.width;
+    return scoreGlyphs.columns;
+}
 
-    int withinDigitX = relX - digitIndex * (digitWidth + digitSpacing);
-    if (withinDigitX >= digitWidth)
-        return false; // In spacing
+// Helper: check if virtual pixel is part of score digit during gameover scroll
+static inline bool isScorePixel(int vx, int vy, uint16_t score, int16_t scrollX)
+{
+    int width;
+    const uint8_t *columns = getScoreColumns(score, &width);
 
-    // Map to font pixel (font is 5x7)
-    int fontX = withinDigitX / SCALE_X;
-    int fontY = (vy - scoreY) / SCALE_Y;
+    // Position relative to scroll
+    int relX = vx - scrollX;
 
-    if (fontX >= FONT_WIDTH || fontY >= FONT_HEIGHT)
+    if (relX < 0 || relX >= width)
+        return false;
+    if (vy < SCORE_Y || vy >= SCORE_Y + SCORE_DIGIT_HEIGHT)
         return false;
 
-    int digit = digits[digitIndex];
-    uint8_t row = digitFont[digit][FONT_HEIGHT - 1 - fontY]; // Flip Y so 0 is bottom
-    return (row >> (FONT_WIDTH - 1 - fontX)) & 1;
+    return (columns[relX] >> ((vy - SCORE_Y) / SCORE_SCALE_Y)) & 1;
 }
 
 // Get the color of a virtual pixel
@@ -261,6 +280,166 @@ void renderFlappyColumn(
     }
 }
 
+// Build a 4-bit row mask for the virtual rows [lo, hi) that fall inside the
+// 4-row window starting at vyStart (bit 0 = vyStart).
+static inline uint8_t spanMask(int vyStart, int lo, int hi)
+{
+    int a = clamp(lo - vyStart, 0, FLAPPY_SCALE);
+    int b = clamp(hi - vyStart, 0, FLAPPY_SCALE);
+    if (a >= b)
+        return 0;
+    return (uint8_t)(((1 << b) - 1) & ~((1 << a) - 1));
+}
+
+static inline int popcount4(uint8_t m)
+{
+    return (m & 1) + ((m >> 1) & 1) + ((m >> 2) & 1) + ((m >> 3) & 1);
+}
+
+// One virtual column inside a whip. Neighbouring columns that see the same
+// primitives are merged, so a whip has 1 lane unless an edge crosses it.
+struct FlappyLane
+{
+    uint8_t weight;   // how many of the whip's 4 virtual columns share this lane
+    bool bird;        // the bird box covers this column
+    uint8_t pipes;    // bit i set = pipe i covers this column
+    uint8_t scoreBits; // gameover: font column bits, bit k = font row k (0 = bottom)
+};
+
+// Render a single physical column from primitive extents.
+// Produces exactly the same bytes as renderFlappyColumn.
+void renderFlappyColumnSpans(
+    uint8_t whipIndex,
+    uint8_t gameState,
+    uint16_t birdY,
+    uint16_t score,
+    int16_t pipe1X, uint16_t pipe1GapY,
+    int16_t pipe2X, uint16_t pipe2GapY,
+    int16_t pipe3X, uint16_t pipe3GapY,
+    int16_t scrollX,
+    uint8_t flashWhip,
+    uint8_t *rgbBuffer)
+{
+    if (whipIndex == flashWhip)
+    {
+        memset(rgbBuffer, 255, FLAPPY_PHYSICAL_HEIGHT * 3);
+        return;
+    }
+
+    const bool gameOver = (gameState == FLAPPY_STATE_GAMEOVER);
+    const int16_t pipeX[3] = {pipe1X, pipe2X, pipe3X};
+    const uint16_t pipeGapY[3] = {pipe1GapY, pipe2GapY, pipe3GapY};
+
+    // Classify the whip's 4 virtual columns and merge identical ones
+    FlappyLane lanes[FLAPPY_SCALE];
+    int numLanes = 0;
+    int vxStart = whipIndex * FLAPPY_SCALE;
+
+    int scoreWidth = 0;
+    const uint8_t *scoreColumns = gameOver ? getScoreColumns(score, &scoreWidth) : NULL;
+
+    for (int dvx = 0; dvx < FLAPPY_SCALE; dvx++)
+    {
+        int vx = vxStart + dvx;
+        FlappyLane lane = {1, false, 0, 0};
+
+        if (gameOver)
+        {
+            int relX = vx - scrollX;
+            if (relX >= 0 && relX < scoreWidth)
+                lane.scoreBits = scoreColumns[relX];
+        }
+        else
+        {
+            lane.bird = (vx >= FLAPPY_BIRD_X && vx < FLAPPY_BIRD_X + FLAPPY_BIRD_WIDTH);
+            for (int i = 0; i < 3; i++)
+            {
+                if (pipeX[i] >= -FLAPPY_PIPE_WIDTH && vx >= pipeX[i] && vx < pipeX[i] + FLAPPY_PIPE_WIDTH)
+                    lane.pipes |= 1 << i;
+            }
+        }
+
+        int j = 0;
+        while (j < numLanes && !(lanes[j].bird == lane.bird &&
+                                 lanes[j].pipes == lane.pipes &&
+                                 lanes[j].scoreBits == lane.scoreBits))
+            j++;
+
+        if (j < numLanes)
+            lanes[j].weight++;
+        else
+            lanes[numLanes++] = lane;
+    }
+
+    // Vertical extents of the primitives
+    const int birdBottom = birdY - FLAPPY_BIRD_HEIGHT / 2;
+    const int birdTop = birdY + FLAPPY_BIRD_HEIGHT / 2;
+
+    for (int led = 0; led < FLAPPY_PHYSICAL_HEIGHT; led++)
+    {
+        int vyStart = led * FLAPPY_SCALE;
+
+        // Ground is in front of everything and the same for every lane
+        uint8_t groundMask = spanMask(vyStart, 0, FLAPPY_GROUND_HEIGHT);
+        uint8_t birdMask = spanMask(vyStart, birdBottom, birdTop) & ~groundMask;
+
+        int nGround = popcount4(groundMask) * FLAPPY_SCALE;
+        int nBird = 0, nPipe = 0, nScore = 0;
+
+        for (int j = 0; j < numLanes; j++)
+        {
+            const FlappyLane &lane = lanes[j];
+
+            if (gameOver)
+            {
+                if (!lane.scoreBits)
+                    continue;
+
+                uint8_t scoreMask = 0;
+                for (int dvy = 0; dvy < FLAPPY_SCALE; dvy++)
+                {
+                    int row = vyStart + dvy - SCORE_Y;
+                    if (row >= 0 && row < SCORE_DIGIT_HEIGHT && ((lane.scoreBits >> (row / SCORE_SCALE_Y)) & 1))
+                        scoreMask |= 1 << dvy;
+                }
+                nScore += popcount4(scoreMask & ~groundMask) * lane.weight;
+                continue;
+            }
+
+            uint8_t laneBird = lane.bird ? birdMask : 0;
+
+            uint8_t pipeMask = 0;
+            for (int i = 0; i < 3; i++)
+            {
+                if (lane.pipes & (1 << i))
+                {
+                    int gapBottom = pipeGapY[i] - FLAPPY_GAP_SIZE / 2;
+                    int gapTop = pipeGapY[i] + FLAPPY_GAP_SIZE / 2;
+                    pipeMask |= ~spanMask(vyStart, gapBottom, gapTop) & 0x0F;
+                }
+            }
+            pipeMask &= ~(groundMask | laneBird);
+
+            nBird += popcount4(laneBird) * lane.weight;
+            nPipe += popcount4(pipeMask) * lane.weight;
+        }
+
+        int nSky = FLAPPY_SCALE * FLAPPY_SCALE - nGround - nBird - nPipe - nScore;
+
+        int rSum = nGround * FLAPPY_COLOR_GROUND_R + nBird * FLAPPY_COLOR_BIRD_R +
+                   nPipe * FLAPPY_COLOR_PIPE_R + nScore * 255 + nSky * FLAPPY_COLOR_SKY_R;
+        int gSum = nGround * FLAPPY_COLOR_GROUND_G + nBird * FLAPPY_COLOR_BIRD_G +
+                   nPipe * FLAPPY_COLOR_PIPE_G + nScore * 255 + nSky * FLAPPY_COLOR_SKY_G;
+        int bSum = nGround * FLAPPY_COLOR_GROUND_B + nBird * FLAPPY_COLOR_BIRD_B +
+                   nPipe * FLAPPY_COLOR_PIPE_B + nScore * 255 + nSky * FLAPPY_COLOR_SKY_B;
+
+        int idx = led * 3;
+        rgbBuffer[idx + 0] = rSum / (FLAPPY_SCALE * FLAPPY_SCALE);
+        rgbBuffer[idx + 1] = gSum / (FLAPPY_SCALE * FLAPPY_SCALE);
+        rgbBuffer[idx + 2] = bSum / (FLAPPY_SCALE * FLAPPY_SCALE);
+    }
+}
+
 // Render the full display (all 24 columns)
 void renderFlappyState(
     uint8_t gameState,
@@ -48,6 +48,12 @@
 extern "C" {
 #endif
 
+/**
+ * The 5x7 font the score is drawn in: 7 rows per digit, top row first,
+ * each 5 bits with the MSB on the left.
+ */
+extern const uint8_t flappyDigitFont[10][7];
+
 /**
  * Render the Flappy Bird game state to an RGB buffer.
  *
@@ -107,6 +113,27 @@ void renderFlappyColumn(
     uint8_t* rgbBuffer
 );
 
+/**
+ * Render a single physical column (whip) analytically.
+ * Instead of sampling all 16 virtual pixels behind each LED, this computes
+ * each LED's coverage directly from the primitive extents (ground band,
+ * bird box, pipe spans). Output is byte-identical to renderFlappyColumn.
+ *
+ * Parameters are the same as renderFlappyColumn.
+ */
+void renderFlappyColumnSpans(
+    uint8_t whipIndex,
+    uint8_t gameState,
+    uint16_t birdY,
+    uint16_t score,
+    int16_t pipe1X, uint16_t pipe1GapY,
+    int16_t pipe2X, uint16_t pipe2GapY,
+    int16_t pipe3X, uint16_t pipe3GapY,
+    int16_t scrollX,
+    uint8_t flashWhip,
+    uint8_t* rgbBuffer
+);
+
 #ifdef __cplusplus
 }
 #endif
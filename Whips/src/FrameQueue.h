@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * FrameQueue is a fixed ring of N slots (a power of two) between one
+ * producer and one consumer, without locks: only the producer moves the
+ * head and only the consumer moves the tail, so either side may run in an
+ * interrupt while the other runs in loop().
+ *
+ * The producer fills the slot BeginPush() returns in place and publishes it
+ * with EndPush(); the consumer reads Front() in place and frees it with
+ * Pop(). Nothing is copied in between.
+ */
+
+template <typename T, uint8_t N>
+class FrameQueue
+{
+    static_assert(N != 0 && (N & (N - 1)) == 0, "FrameQueue size must be a power of two");
+
+public:
+    // producer: the free slot to fill next, or nullptr if the queue is full
+    T *BeginPush()
+    {
+        if (Count() == N)
+            return nullptr;
+        __sync_synchronize(); // the consumer is done with the slot before we write it
+        return &rg[ixHead & (N - 1)];
+    }
+
+    // producer: publish the slot BeginPush() returned
+    void EndPush()
+    {
+        __sync_synchronize(); // the slot is written before it is published
+        ixHead = ixHead + 1;
+    }
+
+    // consumer: the oldest slot, or nullptr if the queue is empty. Next()
+    // is the one after it.
+    T *Front() { return Peek(0); }
+    T *Next() { return Peek(1); }
+
+    // consumer: free the slot Front() returned
+    void Pop()
+    {
+        __sync_synchronize(); // the slot is read before it is handed back
+        ixTail = ixTail + 1;
+    }
+
+    uint8_t Count() const { return (uint8_t)(ixHead - ixTail); }
+
+private:
+    T *Peek(uint8_t i)
+    {
+        if (Count() <= i)
+            return nullptr;
+        __sync_synchronize(); // the slot is read after it was published
+        return &rg[(ixTail + i) & (N - 1)];
+    }
+
+    T rg[N];
+
+    // free-running; the slot is the low bits
+    volatile uint8_t ixHead = 0;
+    volatile uint8_t ixTail = 0;
+};
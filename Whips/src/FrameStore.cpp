@@ -0,0 +1,242 @@
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__IMXRT1062__)
+#include <Arduino.h> // extmem_malloc
+extern "C" uint8_t external_psram_size;
+#endif
+
+#include "FrameStore.h"
+
+#define OP_SKIP 0x00
+#define OP_RUN 0x40
+#define OP_COPY 0x80
+#define OP_MASK 0xC0
+#define OP_MAX_LEDS 64
+
+// worst case encoded frame: all COPY, one header per OP_MAX_LEDS
+#define FRAME_MAX_BYTES (NUM_LEDS * 3 + (NUM_LEDS + OP_MAX_LEDS - 1) / OP_MAX_LEDS)
+
+static uint32_t cbRamPages = 0; // page bytes from the heap, all stores
+static uint32_t cbExtPages = 0; // page bytes from EXTMEM, all stores
+
+static inline bool SameLed(const uint8_t *a, const uint8_t *b)
+{
+    return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+}
+
+// Encodes NUM_LEDS colors as ops. pRef is the previous frame, or nullptr
+// for a keyframe. Returns the number of bytes written to pOut.
+static uint32_t EncodeFrame(const uint8_t *rgb, const uint8_t *pRef, uint8_t *pOut)
+{
+    uint8_t *p = pOut;
+    uint32_t i = 0;
+
+    while (i < NUM_LEDS)
+    {
+        uint32_t j = i + 1;
+
+        if (pRef && SameLed(rgb + i * 3, pRef + i * 3))
+        {
+            while (j < NUM_LEDS && j - i < OP_MAX_LEDS && SameLed(rgb + j * 3, pRef + j * 3))
+                j++;
+            *p++ = OP_SKIP | (j - i - 1);
+        }
+        else if (j < NUM_LEDS && SameLed(rgb + i * 3, rgb + j * 3))
+        {
+            while (j < NUM_LEDS && j - i < OP_MAX_LEDS && SameLed(rgb + i * 3, rgb + j * 3))
+                j++;
+            *p++ = OP_RUN | (j - i - 1);
+            memcpy(p, rgb + i * 3, 3);
+            p += 3;
+        }
+        else
+        {
+            // copy until something a SKIP or RUN would do better
+            while (j < NUM_LEDS && j - i < OP_MAX_LEDS &&
+                   !(pRef && SameLed(rgb + j * 3, pRef + j * 3)) &&
+                   !(j + 1 < NUM_LEDS && SameLed(rgb + j * 3, rgb + (j + 1) * 3)))
+                j++;
+            *p++ = OP_COPY | (j - i - 1);
+            memcpy(p, rgb + i * 3, (j - i) * 3);
+            p += (j - i) * 3;
+        }
+        i = j;
+    }
+    return p - pOut;
+}
+
+// Applies one frame's ops on top of rgb (which holds the frame before)
+static void DecodeFrame(const uint8_t *p, uint8_t *rgb)
+{
+    uint8_t *pLed = rgb;
+    uint8_t *pEnd = rgb + NUM_LEDS * 3;
+
+    while (pLed < pEnd)
+    {
+        uint8_t op = *p++;
+        uint32_t cLeds = (op & ~OP_MASK) + 1;
+
+        switch (op & OP_MASK)
+        {
+        case OP_SKIP:
+            pLed += cLeds * 3;
+            break;
+
+        case OP_RUN:
+            for (uint32_t i = 0; i < cLeds; i++)
+            {
+                pLed[0] = p[0];
+                pLed[1] = p[1];
+                pLed[2] = p[2];
+                pLed += 3;
+            }
+            p += 3;
+            break;
+
+        default:
+            memcpy(pLed, p, cLeds * 3);
+            pLed += cLeds * 3;
+            p += cLeds * 3;
+            break;
+        }
+    }
+}
+
+static FrameStore::Page *AllocPage()
+{
+    FrameStore::Page *pPage = nullptr;
+    bool fExt = false;
+
+    if (cbRamPages + sizeof(FrameStore::Page) <= FRAMESTORE_RAM_BYTES)
+        pPage = (FrameStore::Page *)malloc(sizeof(FrameStore::Page));
+
+#if defined(__IMXRT1062__)
+    if (!pPage && external_psram_size > 0)
+    {
+        pPage = (FrameStore::Page *)extmem_malloc(sizeof(FrameStore::Page));
+        fExt = true;
+    }
+#endif
+
+    if (!pPage)
+        return nullptr;
+
+    pPage->pNext = nullptr;
+    pPage->cbUsed = 0;
+    pPage->fExt = fExt;
+    (fExt ? cbExtPages : cbRamPages) += sizeof(FrameStore::Page);
+    return pPage;
+}
+
+static void FreePage(FrameStore::Page *pPage)
+{
+    (pPage->fExt ? cbExtPages : cbRamPages) -= sizeof(FrameStore::Page);
+#if defined(__IMXRT1062__)
+    if (pPage->fExt)
+    {
+        extmem_free(pPage);
+        return;
+    }
+#endif
+    free(pPage);
+}
+
+void FrameStore::Reset()
+{
+    while (pPages)
+    {
+        Page *pNext = pPages->pNext;
+        FreePage(pPages);
+        pPages = pNext;
+    }
+    free(rgpFrame);
+    free(rgDelay);
+    rgpFrame = nullptr;
+    rgDelay = nullptr;
+    cFrames = 0;
+    cCapacity = 0;
+    cbUsed = 0;
+    iCurrent = -1;
+}
+
+bool FrameStore::Append(const uint8_t *rgb, uint16_t delay)
+{
+    if (cFrames >= MAX_FRAMES)
+        return false;
+
+    if (cFrames == cCapacity)
+    {
+        uint32_t cNew = cCapacity ? cCapacity * 2 : 32;
+        if (cNew > MAX_FRAMES)
+            cNew = MAX_FRAMES;
+        const uint8_t **rgpNew = (const uint8_t **)realloc(rgpFrame, cNew * sizeof(*rgpFrame));
+        if (!rgpNew)
+            return false;
+        rgpFrame = rgpNew;
+        uint16_t *rgNew = (uint16_t *)realloc(rgDelay, cNew * sizeof(*rgDelay));
+        if (!rgNew)
+            return false;
+        rgDelay = rgNew;
+        cbUsed += (cNew - cCapacity) * (sizeof(*rgpFrame) + sizeof(*rgDelay));
+        cCapacity = cNew;
+    }
+
+    uint8_t rgbEncoded[FRAME_MAX_BYTES];
+    bool fKeyframe = (cFrames % FRAMESTORE_KEYFRAME_INTERVAL) == 0;
+    uint32_t cb = EncodeFrame(rgb, fKeyframe ? nullptr : rgbLast, rgbEncoded);
+
+    if (!pPages || pPages->cbUsed + cb > FRAMESTORE_PAGE_BYTES)
+    {
+        Page *pPage = AllocPage();
+        if (!pPage)
+            return false;
+        pPage->pNext = pPages;
+        pPages = pPage;
+    }
+
+    uint8_t *pFrame = pPages->data + pPages->cbUsed;
+    memcpy(pFrame, rgbEncoded, cb);
+    pPages->cbUsed += cb;
+    cbUsed += cb;
+
+    rgpFrame[cFrames] = pFrame;
+    rgDelay[cFrames] = delay;
+    cFrames++;
+    memcpy(rgbLast, rgb, NUM_LEDS * 3);
+    return true;
+}
+
+void FrameStore::GetFrame(uint32_t frame, uint8_t *rgb)
+{
+    if ((int32_t)frame != iCurrent)
+    {
+        uint32_t keyframe = frame - frame % FRAMESTORE_KEYFRAME_INTERVAL;
+        uint32_t from;
+
+        if (iCurrent >= (int32_t)keyframe && iCurrent < (int32_t)frame)
+        {
+            from = iCurrent + 1; // already part way there: playing forward
+        }
+        else
+        {
+            DecodeFrame(rgpFrame[keyframe], rgbCurrent);
+            from = keyframe + 1;
+        }
+
+        for (uint32_t i = from; i <= frame; i++)
+            DecodeFrame(rgpFrame[i], rgbCurrent);
+        iCurrent = frame;
+    }
+    memcpy(rgb, rgbCurrent, NUM_LEDS * 3);
+}
+
+uint32_t FrameStore::RamBytes()
+{
+    return cbRamPages;
+}
+
+uint32_t FrameStore::ExtBytes()
+{
+    return cbExtPages;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * FrameStore holds one whip's strip of every frame of an animation,
+ * compressed, so long animations fit in RAM.
+ *
+ * Every FRAMESTORE_KEYFRAME_INTERVAL frames is a keyframe, encoded on its
+ * own; the frames in between are encoded as changes from the frame before.
+ * Each frame is a list of ops, one header byte each: the top two bits are
+ * the op, the low six bits the number of LEDs it covers minus one (1-64).
+ *
+ *   SKIP n      n LEDs unchanged from the previous frame (not in keyframes)
+ *   RUN n rgb   n LEDs of the same color
+ *   COPY n ...  n colors follow, 3 bytes each
+ *
+ * Encoded frames are packed into FRAMESTORE_PAGE_BYTES pages allocated from
+ * the heap (RAM2 on the Teensy) until FRAMESTORE_RAM_BYTES are in use by all
+ * stores together, then from EXTMEM when PSRAM is fitted.
+ *
+ * GetFrame() decodes from the nearest keyframe, or just one delta when
+ * frames are asked for in order, which is how they are played.
+ */
+
+// On the Whips-Art/Hex/experiment GIFs (test/bench, make run), deltas
+// save under 1% over all keyframes at any interval; most of the 1.35x comes
+// from RUN ops. A random GetFrame() on the host costs 0.6 us at 1, 1.2 us
+// at 4 and 3.2 us at 16, so 4 keeps nearly all the saving for little cost.
+#ifndef FRAMESTORE_KEYFRAME_INTERVAL
+#define FRAMESTORE_KEYFRAME_INTERVAL 4
+#endif
+#define FRAMESTORE_PAGE_BYTES 4096
+
+#ifndef FRAMESTORE_RAM_BYTES
+#define FRAMESTORE_RAM_BYTES (192 * 1024)
+#endif
+
+struct FrameStore
+{
+    // frees all frames
+    void Reset();
+
+    // encodes a frame of NUM_LEDS x 3 bytes onto the end. Returns false if
+    // out of memory or already holding MAX_FRAMES frames.
+    bool Append(const uint8_t *rgb, uint16_t delay);
+
+    // decodes frame (which must be < Frames()) into rgb
+    void GetFrame(uint32_t frame, uint8_t *rgb);
+
+    uint32_t Frames() const { return cFrames; }
+    uint16_t GetDelay(uint32_t frame) const { return rgDelay[frame]; }
+
+    // encoded frames and index, in bytes
+    uint32_t BytesUsed() const { return cbUsed; }
+
+    // page bytes held by all stores, in the heap and in EXTMEM
+    static uint32_t RamBytes();
+    static uint32_t ExtBytes();
+
+    struct Page
+    {
+        Page *pNext;
+        uint32_t cbUsed;
+        bool fExt; // allocated from EXTMEM
+        uint8_t data[FRAMESTORE_PAGE_BYTES];
+    };
+
+    Page *pPages = nullptr;             // newest first
+    const uint8_t **rgpFrame = nullptr; // where each frame's ops start
+    uint16_t *rgDelay = nullptr;        // per-frame delay in ms
+    uint32_t cFrames = 0;
+    uint32_t cCapacity = 0;             // entries allocated in rgpFrame/rgDelay
+    uint32_t cbUsed = 0;
+
+    uint8_t rgbLast[NUM_LEDS * 3];    // the last frame appended, for the encoder
+    uint8_t rgbCurrent[NUM_LEDS * 3]; // the last frame decoded
+    int32_t iCurrent = -1;            // its number, or -1
+};
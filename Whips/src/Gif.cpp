@@ -4,53 +4,166 @@
 
 #include "Util.h"
 #include "Gif.h"
+#include "AnimationFile.h"
+#include "FrameStore.h"
 #include "DipSwitch.h"
 
+// Background loading runs from Gif::loop() between packets. Packets wait in
+// SerialRx's ring meanwhile, and are late by as long as it runs, so each
+// call does about one step.
+#define LOAD_SLICE_MICROS 250
+
+// A load a switch is waiting for gets longer slices, still well inside the
+// 20ms SerialRx's ring holds
+#define LOAD_SLICE_URGENT_MICROS 2000
+#define WHP_FRAMES_PER_STEP 4
+
+// Animations kept decoded for instant switching. Their frames share the
+// FrameStore pool (RAM2, then PSRAM), so memory, not this, usually limits
+// how many stay cached.
+#define GIF_CACHE_ENTRIES 8
+
 namespace Gif
 {
-    CRGB rgbFrames[MAX_FRAMES][NUM_LEDS]; // the buffer that LoadGif() will load into
-    uint32_t cFrames = 0;                 // the number of frames currently loaded
+    // An LRU cache of decoded animations. GetFrame() plays from pShown while
+    // a new animation loads into pLoading a few frames at a time; asking for
+    // one that is still cached switches to it at once.
+    struct CacheEntry
+    {
+        FrameStore store;
+        uint16_t ixGifNumber;
+        bool fValid;       // store holds all of ixGifNumber
+        uint32_t lastUsed; // when it was last shown, in cache ticks
+    };
+
+    CacheEntry cache[GIF_CACHE_ENTRIES];
+    CacheEntry *pShown = nullptr;
+    CacheEntry *pLoading = nullptr;
+    uint32_t tickCache = 0;
+    uint32_t cHits = 0;
+    uint32_t cMisses = 0;
+    uint32_t cEvictions = 0;
+
+    // the load in progress
+    enum LoadSource
+    {
+        loadNone,
+        loadWhp, // reading this whip's block of a .whp
+        loadGif, // decoding a GIF
+    };
+
+    struct LoadJob
+    {
+        LoadSource source;
+        uint16_t ixGifNumber;
+        uint32_t cFramesTotal;         // frames to read (.whp only)
+        int32_t iFrame;                // next frame to fill
+        uint32_t timeStart;
+        bool fShow;                    // show it when loaded, rather than just cache it
+        bool fUrgent;                  // a switch is waiting for it (see HurryPrefetch)
+        File fw;                       // the open .whp
+        uint16_t rgDelays[MAX_FRAMES]; // its delay table
+
+        // one step's worth of .whp frames, or the GIF frame being decoded
+        uint8_t rgbFrames[WHP_FRAMES_PER_STEP][NUM_LEDS * 3];
+    };
+
+    LoadJob job;
+    uint16_t ixGifRequested = 0; // last animation asked for: shown, loading, or failed
+    uint16_t ixGifNoRoom = 0;    // didn't fit beside the one shown; not prefetched again until that changes
 
     AnimatedGIF gif;
     File f;
 
+    CacheEntry *FindCached(uint16_t ixGifNumber);
+    void Show(CacheEntry *pEntry);
+    void Evict(CacheEntry *pEntry);
+    void StartLoad(uint16_t ixGifNumber, bool fShow);
+    bool StartWhp(uint16_t ixGifNumber);
+    bool StartGif(uint16_t ixGifNumber);
+    bool StepLoad();
+    void FinishLoad(bool fSuccess);
+
     void setup()
     {
         dbgprintf("Gif::setup()\n");
         gif.begin(GIF_PALETTE_RGB888);
     }
 
+    // continues a background load for up to LOAD_SLICE_MICROS
     void loop()
     {
+        uint32_t timeStart = micros();
+        uint32_t dtSlice = job.fUrgent ? LOAD_SLICE_URGENT_MICROS : LOAD_SLICE_MICROS;
+        while (job.source != loadNone && micros() - timeStart < dtSlice)
+        {
+            if (!StepLoad())
+                break;
+        }
     }
 
     // called by DOM to learn about a GIF
     // returns true if it exists, false if it doesn't
-    // sets *piDelay to the delay speed to use
-    bool GetGifInfo(uint16_t ixGifNumber, int &iDelay)
+    // fills in gi with its frame count and delays, and if pDelays is given,
+    // up to cDelaysMax of the per-frame delays (gi.iFrameCount is then the
+    // number of frames actually played)
+    bool GetGifInfo(uint16_t ixGifNumber, GIFINFO &gi, uint16_t *pDelays, uint32_t cDelaysMax)
     {
+        if (job.source == loadGif)
+        {
+            // the decoder can only have one GIF open
+            dbgprintf("Cancelling load of animation %d\n", job.ixGifNumber);
+            FinishLoad(false);
+        }
+
+        if (GetWhpInfo(ixGifNumber, gi, pDelays, cDelaysMax))
+            return true;
+
         char rgchFileName[12];  // "/65535.gif" + null = 11 chars max
         sprintf(rgchFileName, "/%03d.gif", ixGifNumber);
 
         uint32_t timeStart = millis();
         if (gif.open(rgchFileName, GIFOpenFile, GIFCloseFile, GIFReadFile, GIFSeekFile, GIFDraw))
         {
-            GIFINFO gi;
-
             dbgprintf("Successfully opened GIF %s; Canvas size = %d x %d\n", rgchFileName, gif.getCanvasWidth(), gif.getCanvasHeight());
 
+            if (pDelays)
+            {
+                // getInfo() only sums them up, so play it through for each
+                // one instead, and work out the rest from them
+                int iDelay;
+                uint32_t cFrames = 0;
+                gi.iDuration = 0;
+                gi.iMinDelay = INT32_MAX;
+                gi.iMaxDelay = 0;
+                while (cFrames < cDelaysMax)
+                {
+                    int iResult = gif.playFrame(false, &iDelay, nullptr);
+                    if (iResult < 0)
+                        break;
+                    pDelays[cFrames++] = iDelay;
+                    gi.iDuration += iDelay;
+                    gi.iMinDelay = min(gi.iMinDelay, (int32_t)iDelay);
+                    gi.iMaxDelay = max(gi.iMaxDelay, (int32_t)iDelay);
+                    if (iResult == 0)
+                        break;
+                }
+                gi.iFrameCount = cFrames;
+                if (cFrames == 0)
+                    gi.iMinDelay = 0;
+            }
             // The getInfo() method can be slow since it walks through the entire GIF file to count the frames
-            // and gather info about total play time. Comment out this section if you don't need this info
-            if (gif.getInfo(&gi))
+            // and gather info about total play time.
+            else if (!gif.getInfo(&gi))
             {
-                dbgprintf("frame count: %d\n", gi.iFrameCount);
-                dbgprintf("duration: %d ms\n", gi.iDuration);
-                dbgprintf("max delay: %d ms\n", gi.iMaxDelay);
-                dbgprintf("min delay: %d ms\n", gi.iMinDelay);
-
-                iDelay = gi.iMinDelay;
+                gi.iFrameCount = 0;
             }
 
+            dbgprintf("frame count: %d\n", gi.iFrameCount);
+            dbgprintf("duration: %d ms\n", gi.iDuration);
+            dbgprintf("max delay: %d ms\n", gi.iMaxDelay);
+            dbgprintf("min delay: %d ms\n", gi.iMinDelay);
+
             gif.close();
             dbgprintf("Reading GIF took %d millis\n", millis() - timeStart);
             return true;
@@ -61,44 +174,407 @@ namespace Gif
         }
     }
 
+    // reads the header and delay table of /NNN.whp. Returns false if there
+    // is no usable .whp; on success the file is left open after the delays.
+    bool OpenWhp(uint16_t ixGifNumber, File &fw, AnimationFile::Header &hdr, uint16_t *pDelays, uint32_t cDelaysMax)
+    {
+        char rgchFileName[12];  // "/65535.whp" + null = 11 chars max
+        sprintf(rgchFileName, "/%03d.whp", ixGifNumber);
+
+        fw = SD.open(rgchFileName);
+        if (!fw)
+            return false;
+
+        if (fw.read((uint8_t *)&hdr, sizeof(hdr)) != sizeof(hdr) || !AnimationFile::IsValid(hdr))
+        {
+            dbgprintf("%s is not a valid animation file\n", rgchFileName);
+            fw.close();
+            return false;
+        }
+
+        uint32_t cbDelays = min((uint32_t)hdr.cFrames, cDelaysMax) * sizeof(uint16_t);
+        if (fw.read((uint8_t *)pDelays, cbDelays) != (int)cbDelays)
+        {
+            dbgprintf("%s is truncated\n", rgchFileName);
+            fw.close();
+            return false;
+        }
+        return true;
+    }
+
+    bool GetWhpInfo(uint16_t ixGifNumber, GIFINFO &gi, uint16_t *pDelays, uint32_t cDelaysMax)
+    {
+        File fw;
+        AnimationFile::Header hdr;
+        static uint16_t rgInfoDelays[MAX_FRAMES]; // not job's: a load may be in progress
+        if (!OpenWhp(ixGifNumber, fw, hdr, rgInfoDelays, MAX_FRAMES))
+            return false;
+        fw.close();
+
+        gi.iFrameCount = hdr.cFrames;
+        gi.iDuration = 0;
+        gi.iMinDelay = rgInfoDelays[0];
+        gi.iMaxDelay = rgInfoDelays[0];
+        for (uint32_t i = 0; i < min((uint32_t)hdr.cFrames, (uint32_t)MAX_FRAMES); i++)
+        {
+            gi.iDuration += rgInfoDelays[i];
+            gi.iMinDelay = min(gi.iMinDelay, (int32_t)rgInfoDelays[i]);
+            gi.iMaxDelay = max(gi.iMaxDelay, (int32_t)rgInfoDelays[i]);
+        }
+
+        if (pDelays)
+        {
+            gi.iFrameCount = min((uint32_t)gi.iFrameCount, min(cDelaysMax, (uint32_t)MAX_FRAMES));
+            memcpy(pDelays, rgInfoDelays, gi.iFrameCount * sizeof(uint16_t));
+        }
+
+        dbgprintf("animation %d: %d frames, delay %d-%d ms\n", ixGifNumber, gi.iFrameCount, gi.iMinDelay, gi.iMaxDelay);
+        return true;
+    }
+
+    // Starts loading ixGifNumber in the background, from its .whp if there
+    // is one, otherwise by decoding the GIF. Gif::loop() does the work; the
+    // animation being shown keeps playing until the new one is complete.
+    // Asking again for the animation already shown or loading does nothing.
+    void LoadGifAsync(uint16_t ixGifNumber)
+    {
+        if (ixGifNumber == ixGifRequested)
+            return;
+        ixGifRequested = ixGifNumber;
+
+        if (job.source != loadNone && job.ixGifNumber == ixGifNumber)
+        {
+            job.fShow = true; // already prefetching it
+            return;
+        }
+
+        if (job.source != loadNone)
+        {
+            dbgprintf("Abandoning load of animation %d\n", job.ixGifNumber);
+            FinishLoad(false);
+        }
+
+        CacheEntry *pCached = FindCached(ixGifNumber);
+        if (pCached)
+        {
+            cHits++;
+            Show(pCached);
+            dbgprintf("Gif cache hit for %d (%d hits, %d misses, %d evictions)\n", ixGifNumber, cHits, cMisses, cEvictions);
+            return;
+        }
+
+        cMisses++;
+        dbgprintf("Loading gif number %d: cache miss (%d hits, %d misses, %d evictions)\n", ixGifNumber, cHits, cMisses, cEvictions);
+        StartLoad(ixGifNumber, true);
+    }
+
+    // Starts loading ixGifNumber into the cache in the background, without
+    // showing it, so a later switch to it is instant. A load already in
+    // progress is left to finish; the DOM repeats its prefetch until then.
+    void Prefetch(uint16_t ixGifNumber)
+    {
+        if (job.source != loadNone || FindCached(ixGifNumber) || ixGifNumber == ixGifNoRoom)
+            return;
+
+        dbgprintf("Prefetching gif number %d\n", ixGifNumber);
+        StartLoad(ixGifNumber, false);
+    }
+
+    // A switch to ixGifNumber is coming: if it isn't cached yet (say this
+    // whip missed the prefetch), starts its load if need be and gives it
+    // longer slices. A prefetch of something else is dropped for it; a load
+    // of the animation to show now is hurried along too, and the DOM's next
+    // commit starts ours. Nothing waits here: Playback keeps playing the
+    // old one until this one is cached. One that doesn't fit beside the
+    // animation shown is left to load in its place when it's asked to show.
+    void HurryPrefetch(uint16_t ixGifNumber)
+    {
+        if (FindCached(ixGifNumber) || ixGifNumber == ixGifNoRoom)
+            return;
+
+        if (job.source != loadNone && job.ixGifNumber != ixGifNumber && !job.fShow)
+        {
+            dbgprintf("Abandoning prefetch of animation %d\n", job.ixGifNumber);
+            FinishLoad(false);
+        }
+        if (job.source == loadNone)
+            StartLoad(ixGifNumber, false);
+        job.fUrgent = true;
+    }
+
+    // takes the cache entry for ixGifNumber and starts reading it
+    void StartLoad(uint16_t ixGifNumber, bool fShow)
+    {
+        // the least recently shown entry, preferring empty ones
+        pLoading = nullptr;
+        for (CacheEntry &entry : cache)
+        {
+            if (&entry == pShown)
+                continue;
+            if (!pLoading || (pLoading->fValid && (!entry.fValid || entry.lastUsed < pLoading->lastUsed)))
+                pLoading = &entry;
+        }
+        if (pLoading->fValid)
+            Evict(pLoading);
+        pLoading->ixGifNumber = ixGifNumber;
+
+        job.ixGifNumber = ixGifNumber;
+        job.fShow = fShow;
+        job.fUrgent = false;
+        job.iFrame = 0;
+        job.timeStart = millis();
+        memset(job.rgbFrames, 0, sizeof(job.rgbFrames));
+
+        if (!StartWhp(ixGifNumber) && !StartGif(ixGifNumber))
+        {
+            job.source = loadNone;
+            pLoading = nullptr;
+        }
+    }
+
+    // loads ixGifNumber from the card right away, without returning until it
+    // is shown, even if it was cached
     void LoadGif(uint16_t ixGifNumber)
+    {
+        CacheEntry *pCached = FindCached(ixGifNumber);
+        if (pCached)
+        {
+            if (pCached == pShown)
+                pShown = nullptr;
+            pCached->store.Reset();
+            pCached->fValid = false;
+        }
+
+        ixGifRequested = 0; // force a reload
+        LoadGifAsync(ixGifNumber);
+        while (job.source != loadNone && StepLoad())
+            ;
+    }
+
+    bool IsLoading()
+    {
+        return job.source != loadNone;
+    }
+
+    bool IsCached(uint16_t ixGifNumber)
+    {
+        return FindCached(ixGifNumber) != nullptr;
+    }
+
+    CacheEntry *FindCached(uint16_t ixGifNumber)
+    {
+        for (CacheEntry &entry : cache)
+        {
+            if (entry.fValid && entry.ixGifNumber == ixGifNumber)
+                return &entry;
+        }
+        return nullptr;
+    }
+
+    void Show(CacheEntry *pEntry)
+    {
+        if (pEntry != pShown)
+            ixGifNoRoom = 0;
+        pShown = pEntry;
+        pEntry->lastUsed = ++tickCache;
+    }
+
+    void Evict(CacheEntry *pEntry)
+    {
+        cEvictions++;
+        dbgprintf("Evicting gif %d from cache (%d bytes)\n", pEntry->ixGifNumber, pEntry->store.BytesUsed());
+        pEntry->store.Reset();
+        pEntry->fValid = false;
+    }
+
+    // Appends a frame to the animation loading. If the frame pool is full,
+    // evicts the least recently shown cached animations, then the one shown
+    // if this load is to replace it (the whip is dark until it's done).
+    // Returns false if there is still no room: the load fails rather than
+    // play fewer frames than the DOM's catalog says it has.
+    bool AppendFrame(const uint8_t *rgb, uint16_t delay)
+    {
+        while (!pLoading->store.Append(rgb, delay))
+        {
+            CacheEntry *pVictim = nullptr;
+            for (CacheEntry &entry : cache)
+            {
+                if (entry.fValid && &entry != pShown && (!pVictim || entry.lastUsed < pVictim->lastUsed))
+                    pVictim = &entry;
+            }
+            if (!pVictim && job.fShow && pShown)
+            {
+                pVictim = pShown;
+                pShown = nullptr;
+            }
+            if (!pVictim)
+            {
+                dbgprintf("No room for animation %d after %d frames\n", job.ixGifNumber, pLoading->store.Frames());
+                ixGifNoRoom = job.ixGifNumber;
+                return false;
+            }
+            Evict(pVictim);
+        }
+        return true;
+    }
+
+    bool StartWhp(uint16_t ixGifNumber)
+    {
+        AnimationFile::Header hdr;
+        if (!OpenWhp(ixGifNumber, job.fw, hdr, job.rgDelays, MAX_FRAMES))
+            return false;
+
+        uint8_t whip = DipSwitch::getWhipNumber();
+        if (hdr.cLeds != NUM_LEDS || whip >= hdr.cWhips || !job.fw.seek(AnimationFile::WhipOffset(hdr, whip)))
+        {
+            dbgprintf("animation %d is %d x %d, can't play it on whip %d\n", ixGifNumber, hdr.cLeds, hdr.cWhips, whip);
+            job.fw.close();
+            return false;
+        }
+
+        job.source = loadWhp;
+        job.cFramesTotal = min((uint32_t)hdr.cFrames, (uint32_t)MAX_FRAMES);
+        return true;
+    }
+
+    bool StartGif(uint16_t ixGifNumber)
     {
         char rgchFileName[12];  // "/65535.gif" + null = 11 chars max
         sprintf(rgchFileName, "/%03d.gif", ixGifNumber);
 
-        uint32_t timeStart = millis();
-        if (gif.open(rgchFileName, GIFOpenFile, GIFCloseFile, GIFReadFile, GIFSeekFile, GIFDraw))
+        if (!gif.open(rgchFileName, GIFOpenFile, GIFCloseFile, GIFReadFile, GIFSeekFile, GIFDraw))
         {
-            dbgprintf("Successfully opened GIF %s; Canvas size = %d x %d\n", rgchFileName, gif.getCanvasWidth(), gif.getCanvasHeight());
+            dbgprintf("Error opening file = %d\n", gif.getLastError());
+            return false;
+        }
+
+        dbgprintf("Successfully opened GIF %s; Canvas size = %d x %d\n", rgchFileName, gif.getCanvasWidth(), gif.getCanvasHeight());
 
-            if (gif.allocFrameBuf(GIFAlloc) == GIF_SUCCESS)
+        if (gif.allocFrameBuf(GIFAlloc) != GIF_SUCCESS)
+        {
+            dbgprintf("Insufficient memory\n");
+            gif.close();
+            return false;
+        }
+        gif.setDrawType(GIF_DRAW_COOKED);
+
+        job.source = loadGif;
+        return true;
+    }
+
+    // does one unit of work: WHP_FRAMES_PER_STEP frames of a .whp, or one GIF
+    // frame. Returns false when the load has finished (or failed).
+    bool StepLoad()
+    {
+        if (job.source == loadWhp)
+        {
+            uint32_t cFramesStep = min((uint32_t)WHP_FRAMES_PER_STEP, job.cFramesTotal - job.iFrame);
+            int cb = cFramesStep * NUM_LEDS * 3;
+            if (job.fw.read((uint8_t *)job.rgbFrames, cb) != cb)
             {
-                gif.setDrawType(GIF_DRAW_COOKED);
+                dbgprintf("animation %d is truncated\n", job.ixGifNumber);
+                FinishLoad(false);
+                return false;
+            }
 
-                int32_t iFrame = 0;
-                while (gif.playFrame(false, NULL, &iFrame))
+            for (uint32_t i = 0; i < cFramesStep; i++, job.iFrame++)
+            {
+                if (!AppendFrame(job.rgbFrames[i], job.rgDelays[job.iFrame]))
                 {
-                    iFrame++;
+                    FinishLoad(false);
+                    return false;
                 }
-                gif.freeFrameBuf(GIFFree);
             }
-            else
+
+            if ((uint32_t)job.iFrame == job.cFramesTotal)
+            {
+                FinishLoad(true);
+                return false;
+            }
+            return true;
+        }
+
+        if (job.source == loadGif)
+        {
+            // GIFDraw leaves this whip's line in job.rgbFrames[0]; a frame that
+            // doesn't touch it repeats the one before
+            int iDelay;
+            int iResult = gif.playFrame(false, &iDelay, &job.iFrame);
+            if (iResult >= 0)
+            {
+                if (!AppendFrame(job.rgbFrames[0], iDelay))
+                {
+                    FinishLoad(false);
+                    return false;
+                }
+
+                // the catalog stops counting here too (see GetGifInfo)
+                if (++job.iFrame >= MAX_FRAMES)
+                    iResult = 0;
+            }
+
+            // a decode error ends the animation where GetGifInfo's count did
+            if (iResult <= 0)
             {
-                dbgprintf("Insufficient memory\n");
+                FinishLoad(pLoading->store.Frames() > 0);
+                return false;
             }
+            return true;
+        }
 
+        return false;
+    }
+
+    // closes the job's files and, if it worked, shows the new animation
+    void FinishLoad(bool fSuccess)
+    {
+        if (job.source == loadWhp)
+        {
+            job.fw.close();
+        }
+        else if (job.source == loadGif)
+        {
+            gif.freeFrameBuf(GIFFree);
             gif.close();
-            dbgprintf("Reading GIF took %d millis\n", millis() - timeStart);
+        }
+        job.source = loadNone;
+        job.fUrgent = false;
+
+        if (fSuccess)
+        {
+            pLoading->fValid = true;
+            if (job.fShow)
+                Show(pLoading);
+            else
+                pLoading->lastUsed = ++tickCache; // newest, so it's the last to be evicted
+            dbgprintf("Reading animation %d (%d frames, %d bytes) took %d millis\n", job.ixGifNumber, pLoading->store.Frames(), pLoading->store.BytesUsed(), millis() - job.timeStart);
+            dbgprintf("Frame pool: %d bytes RAM, %d bytes PSRAM\n", FrameStore::RamBytes(), FrameStore::ExtBytes());
         }
         else
         {
-            dbgprintf("Error opening file = %d\n", gif.getLastError());
+            pLoading->store.Reset();
+        }
+        pLoading = nullptr;
+    }
+
+    uint32_t GetFrame(uint32_t frame, CRGB *leds)
+    {
+        if (!pShown)
+        {
+            memset(leds, 0, NUM_LEDS * 3); // nothing loaded yet
+            return GIF_NO_FRAME;
         }
+        uint32_t ixFrame = frame % pShown->store.Frames();
+        pShown->store.GetFrame(ixFrame, (uint8_t *)leds);
+        return ((uint32_t)pShown->ixGifNumber << 16) | ixFrame;
     }
 
-    void GetFrame(uint32_t frame, CRGB *leds)
+    // how long frame is shown for, in ms
+    uint16_t GetFrameDelay(uint32_t frame)
     {
-        memcpy(leds, rgbFrames[frame % cFrames], NUM_LEDS * 3);
+        if (!pShown)
+            return GIF_DEFAULT_DELAY_MS;
+        return max(pShown->store.GetDelay(frame % pShown->store.Frames()), (uint16_t)GIF_MIN_DELAY_MS);
     }
 
     void *GIFOpenFile(const char *fname, int32_t *pSize)
@@ -147,9 +623,7 @@ namespace Gif
         int line = pDraw->y;
         if (line == DipSwitch::getWhipNumber())
         {
-            int32_t frame = *(int32_t *)(pDraw->pUser);
-            memcpy(rgbFrames[frame], pDraw->pPixels, NUM_LEDS * 3);
-            cFrames = frame + 1;
+            memcpy(job.rgbFrames[0], pDraw->pPixels, NUM_LEDS * 3);
         }
     }
 
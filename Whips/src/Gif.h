@@ -9,12 +9,33 @@
  * Animated GIF handling
  */
 
+// frame timing for GIFs without a delay table, and the shortest delay
+// honored (browsers treat 0 and 10 ms delays as "as fast as possible" too).
+// The DOM and the whips must agree on these to count frames the same way.
+#define GIF_DEFAULT_DELAY_MS 40
+#define GIF_MIN_DELAY_MS 20
+
+#define GIF_NO_FRAME 0xFFFFFFFF
+#define GIF_FRAME_GIF(key) ((uint16_t)((key) >> 16))
+#define GIF_FRAME_INDEX(key) ((uint16_t)(key))
+
 namespace Gif
 {
     void setup();
+    void loop();
     void LoadGif(uint16_t ixGifNumber);
-    bool GetGifInfo(uint16_t ixGifNumber, int &iDelay);
-    void GetFrame(uint32_t frame, CRGB *leds);
+    void LoadGifAsync(uint16_t ixGifNumber);
+    void Prefetch(uint16_t ixGifNumber);
+    void HurryPrefetch(uint16_t ixGifNumber);
+    bool IsLoading();
+    bool IsCached(uint16_t ixGifNumber);
+    bool GetGifInfo(uint16_t ixGifNumber, GIFINFO &gi, uint16_t *pDelays = nullptr, uint32_t cDelaysMax = 0);
+    // returns which frame of which GIF it was (GIF_FRAME_GIF, GIF_FRAME_INDEX),
+    // or GIF_NO_FRAME if none is loaded
+    uint32_t GetFrame(uint32_t frame, CRGB *leds);
+    uint16_t GetFrameDelay(uint32_t frame);
+
+    bool GetWhpInfo(uint16_t ixGifNumber, GIFINFO &gi, uint16_t *pDelays = nullptr, uint32_t cDelaysMax = 0);
 
     void *GIFOpenFile(const char *fname, int32_t *pSize);
     void GIFCloseFile(void *pHandle);
@@ -1,152 +1,585 @@
 #include <Arduino.h>
-#include <PacketSerial.h>
-#include <CRC16.h>
-#include <CRC.h>
 
 #include "pins.h"
 #include "Util.h"
 #include "Led.h"
 #include "Commands.h"
+#include "Checksum.h"
 #include "DipSwitch.h"
 #include "Gif.h"
+#include "Playback.h"
 #include "FlappyRender.h"
+#include "FrameQueue.h"
+#include "SerialRx.h"
+#include "EncodedCache.h"
+#include "ColorLut.h"
+#include "Dither.h"
+#include "Overlay.h"
+
+// frames rendered ahead of the strip; more than this and new ones are dropped
+#define LED_QUEUE_FRAMES 4
+
+// a frame due this soon after the strip is free is waited for, so it goes
+// out on time rather than on some later pass through loop()
+#define LED_SPIN_MICROS 200
+
+// The whip's LEDs may be split across up to 4 pins (pinLEDStrip,
+// pinLEDStrip2, ...), each a strip of its own sent at the same time as the
+// others, so a frame takes 1/LED_STRIPS as long to send
+#ifndef LED_STRIPS
+#define LED_STRIPS 1
+#endif
+static_assert(LED_STRIPS >= 1 && LED_STRIPS <= 4, "LED_STRIPS must be 1 to 4");
+
+// sending and latching a frame on the longest strip
+#define LED_REFRESH_MICROS ((NUM_LEDS + LED_STRIPS - 1) / LED_STRIPS * 30 + 300)
+
+// The strip is refreshed between content frames to dither it, or to show
+// the last frame again with a change of overlay or brightness. A refresh
+// starts only when it will be done LED_GAP_MARGIN_MICROS before the next
+// content frame: when Playback's next frame is due, or else the shortest of
+// the last LED_GAPS gaps between content frames after the last one. Once
+// they have stopped for LED_GAP_IDLE_MICROS it refreshes regardless.
+#define LED_GAP_MARGIN_MICROS 1000
+#define LED_GAP_IDLE_MICROS 250000
+#define LED_GAPS 8
+
+// Below LED_DITHER_BRIGHTNESS the strip is refreshed with temporal
+// dithering (see Dither.h). The encoded frame cache needs every showing of
+// a frame to be the same, so it's one or the other.
+#ifndef LED_TEMPORAL_DITHER
+#define LED_TEMPORAL_DITHER (!GIF_PREENCODED)
+#endif
+#if LED_TEMPORAL_DITHER && GIF_PREENCODED
+#error "LED_TEMPORAL_DITHER and GIF_PREENCODED don't go together"
+#endif
+#define LED_DITHER_BRIGHTNESS 64
+
+// how long the overlays (see Overlay.h) stay up
+#define LED_BAR_MILLIS 200
+#define LED_IDENTIFY_MILLIS 3000
+#define LED_WARNING_MILLIS 1000
 
 namespace Led
 {
 
     CRGB leds[NUM_LEDS];
-    PacketSerial packetSerial;
     uint8_t brightness = 32;
 
+    // Packets are rendered as they arrive into a queue of frames, each to be
+    // shown at its presentation deadline; output() sends them on whenever
+    // the strip has finished with the last one. Neither stage waits for the
+    // other.
+    struct Frame
+    {
+        CRGB leds[NUM_LEDS];
+        uint32_t timeDue; // micros() to show it at
+        uint32_t key;     // which GIF frame it is, or GIF_NO_FRAME
+    };
+
+    FrameQueue<Frame, LED_QUEUE_FRAMES> frameQueue;
+    uint32_t cFramesShown = 0;
+    uint32_t cFramesSuperseded = 0; // a later one was due before the strip was free
+    uint32_t cFramesDropped = 0;    // the queue was full
+    uint32_t cFramesElided = 0;     // the same as what the strip had
+    uint8_t cQueueMax = 0;
+
+    // the content frame the strip has, at the brightness and with the
+    // overlays it has it, so an unchanged frame needn't go out again
+    CRGB ledsStrip[NUM_LEDS];
+    uint8_t brightnessStrip = 0;
+    uint32_t stateStrip = 0;
+    bool fStripKnown = false;
+    uint32_t cBadPacketsSeen = 0;
+
+    // a fade (cmdFadeBrightness) from brightnessFrom at timeFadeStart to
+    // brightnessFade msFade later
+    bool fFading = false;
+    uint8_t brightnessFrom = 0;
+    uint8_t brightnessFade = 0;
+    uint32_t timeFadeStart = 0;
+    uint16_t msFade = 0;
+
+    // strip ix of LED_STRIPS, from the base of the whip out
+    template <uint8_t pin>
+    static void addStrip(int ix)
+    {
+        int ixFirst = ix * NUM_LEDS / LED_STRIPS;
+        int ixLast = (ix + 1) * NUM_LEDS / LED_STRIPS;
+        FastLED.addLeds<WS2812SERIAL, pin, BGR>(leds, ixFirst, ixLast - ixFirst);
+    }
+
     void setup()
     {
-        Serial1.begin(2000000);
-        packetSerial.setStream(&Serial1);
-        packetSerial.setPacketHandler(&onPacketReceived);
+        SerialRx::setup(2000000, &onPacketReceived);
 
-        FastLED.addLeds<WS2812SERIAL, pinLEDStrip, BGR>(leds, NUM_LEDS);
+        addStrip<pinLEDStrip>(0);
+#if LED_STRIPS > 1
+        addStrip<pinLEDStrip2>(1);
+#endif
+#if LED_STRIPS > 2
+        addStrip<pinLEDStrip3>(2);
+#endif
+#if LED_STRIPS > 3
+        addStrip<pinLEDStrip4>(3);
+#endif
         FastLED.setBrightness(brightness);
+        ColorLut::SetBrightness(brightness);
+#if GIF_PREENCODED
+        // every showing of a frame must encode the same, to be cached
+        FastLED.setDither(DISABLE_DITHER);
+#endif
         FastLED.showColor(CRGB::DarkOrange);
 
+        // FastLED made the strips for that; with a second frame buffer each
+        // can encode the next frame while the last one is still going out
+        WS2812Serial *pStrip;
+        for (uint8_t i = 0; (pStrip = WS2812Serial::instance(i)); i++)
+            pStrip->setBackBuffer(malloc(pStrip->encodedBytes()));
+
+        // the whip number over the start-up color for a while, drawn by
+        // output() like any overlay
+        for (int i = 0; i < NUM_LEDS; i++)
+            ledsStrip[i] = CRGB::DarkOrange;
+        brightnessStrip = ColorLut::Brightness();
+        fStripKnown = true;
+        Overlay::ShowIdentify(DipSwitch::getWhipNumber(), LED_IDENTIFY_MILLIS);
+
         pinMode(pinLEDRxIndicator, OUTPUT);
     }
 
+    static void pushFrame()
+    {
+        frameQueue.EndPush();
+        if (frameQueue.Count() > cQueueMax)
+            cQueueMax = frameQueue.Count();
+    }
+
+    // The slot for a command's frame, or nullptr if there's no room
+    static Frame *beginFrame()
+    {
+        Frame *pFrame = frameQueue.BeginPush();
+        if (!pFrame)
+            cFramesDropped++;
+        else
+            pFrame->key = GIF_NO_FRAME;
+        return pFrame;
+    }
+
+    // the command's presentation deadline, the same moment on every whip
+    // whatever its place in the chain
+    static uint32_t deadline(const cmdUnknown *punk, uint32_t timeReceived)
+    {
+        int32_t hold = (int32_t)punk->holdMicros - (int32_t)DipSwitch::getHopMicros();
+        return timeReceived + max(hold, 0);
+    }
+
+    // Queues it for the command's presentation deadline
+    static void endFrame(Frame *pFrame, const cmdUnknown *punk, uint32_t timeReceived)
+    {
+        pFrame->timeDue = deadline(punk, timeReceived);
+        pushFrame();
+    }
+
+    static void fillFrame(Frame *pFrame, const CRGB &rgb)
+    {
+        for (int i = 0; i < NUM_LEDS; i++)
+            pFrame->leds[i] = rgb;
+    }
+
+    // leds, ready for the strip but for the overlays, goes out
+    static void send()
+    {
+        stateStrip = Overlay::State();
+        Overlay::Composite(leds);
+        FastLED.show(255);
+    }
+
+    uint32_t timeContentLast = 0;
+    uint32_t rgdtContent[LED_GAPS]; // the last gaps between content frames
+    uint8_t ixdtContent = 0;
+    uint8_t cdtContent = 0;
+    uint32_t dtContentMin = 0; // the shortest of them; 0 until there are enough
+
+    // a content frame is due at timeDue, whether it changes anything or not
+    static void noteContent(uint32_t timeDue)
+    {
+        rgdtContent[ixdtContent] = timeDue - timeContentLast;
+        ixdtContent = (ixdtContent + 1) % LED_GAPS;
+        if (cdtContent < LED_GAPS)
+            cdtContent++;
+        timeContentLast = timeDue;
+        dtContentMin = 0;
+        if (cdtContent == LED_GAPS)
+        {
+            dtContentMin = rgdtContent[0];
+            for (int i = 1; i < LED_GAPS; i++)
+                dtContentMin = min(dtContentMin, rgdtContent[i]);
+        }
+    }
+
+    // true if a refresh that starts now can't hold up the next content frame
+    static bool gapAhead()
+    {
+        uint32_t now = micros();
+        uint32_t timeNext;
+        if (Playback::NextFrameDue(timeNext))
+            return (int32_t)(timeNext - now) >= LED_REFRESH_MICROS + LED_GAP_MARGIN_MICROS;
+
+        uint32_t since = now - timeContentLast;
+        return since >= LED_GAP_IDLE_MICROS || since + LED_REFRESH_MICROS + LED_GAP_MARGIN_MICROS <= dtContentMin;
+    }
+
+#if LED_TEMPORAL_DITHER
+    uint32_t cRefreshes = 0;
+
+    // Sends the content frame in leds, the first refresh of it dithered if
+    // the brightness is low
+    static void showContent()
+    {
+        Dither::SetFrame(leds);
+        if (ColorLut::Brightness() >= LED_DITHER_BRIGHTNESS)
+            ColorLut::Apply(leds, leds);
+        else
+            Dither::Render(leds);
+        send();
+    }
+
+    // Another dithered refresh of the content frame, if the strip is free
+    // and the next content frame can't come before it's done
+    static void refresh()
+    {
+        if (timeContentLast == 0 || ColorLut::Brightness() >= LED_DITHER_BRIGHTNESS || WS2812Serial::anyBusy() || !gapAhead())
+            return;
+
+        Dither::Render(leds);
+        send();
+        cRefreshes++;
+    }
+#else
+    static void showContent()
+    {
+        ColorLut::Apply(leds, leds);
+        send();
+    }
+#endif
+
+    // Sends what the strip has again when an overlay has come or gone, or
+    // the brightness has changed, and the next content frame can't come
+    // before it's done
+    static void redraw()
+    {
+        if (!fStripKnown || WS2812Serial::anyBusy())
+            return;
+        if (stateStrip == Overlay::State() && brightnessStrip == ColorLut::Brightness())
+            return;
+        if (!gapAhead())
+            return;
+
+        memcpy(leds, ledsStrip, sizeof(leds));
+        brightnessStrip = ColorLut::Brightness();
+        showContent();
+    }
+
+    // Sends the next frame to the strip once it is due and the strip has
+    // no frame waiting; the strip starts it once the one before has latched
+    static void output()
+    {
+        Frame *pFrame;
+        while ((pFrame = frameQueue.Next()) && (int32_t)(micros() - pFrame->timeDue) >= 0)
+        {
+            frameQueue.Pop();
+            cFramesSuperseded++;
+        }
+
+        pFrame = frameQueue.Front();
+        if (!pFrame)
+        {
+            redraw();
+#if LED_TEMPORAL_DITHER
+            refresh();
+#endif
+            return;
+        }
+        if (WS2812Serial::anyWaiting())
+            return;
+
+        int32_t wait = pFrame->timeDue - micros();
+        if (wait > LED_SPIN_MICROS)
+            return;
+        noteContent(pFrame->timeDue);
+
+        // the strip has this already (the DOM repeats solid colors, and
+        // most of Flappy's columns stay the same): no need to send it
+        if (fStripKnown && brightnessStrip == ColorLut::Brightness() && stateStrip == Overlay::State() &&
+            memcmp(ledsStrip, pFrame->leds, sizeof(ledsStrip)) == 0)
+        {
+            frameQueue.Pop();
+            cFramesElided++;
+            return;
+        }
+
+        if (wait > 0)
+            delayMicroseconds(wait);
+
+        cFramesShown++;
+        memcpy(ledsStrip, pFrame->leds, sizeof(ledsStrip));
+        brightnessStrip = ColorLut::Brightness();
+        fStripKnown = true;
+
+#if GIF_PREENCODED
+        // a GIF frame we've sent before goes straight from the cache, each
+        // strip's part after the one before. The cache has frames without
+        // overlays.
+        uint32_t key = pFrame->key;
+        WS2812Serial *pStrip;
+        bool fCache = WS2812Serial::instance(0) && Overlay::State() == 0;
+        const uint8_t *pEncoded = fCache ? EncodedCache::Find(key, ColorLut::Brightness()) : nullptr;
+        if (pEncoded)
+        {
+            frameQueue.Pop();
+            for (uint8_t i = 0; (pStrip = WS2812Serial::instance(i)); i++)
+            {
+                pStrip->showEncoded(pEncoded);
+                pEncoded += pStrip->encodedBytes();
+            }
+            return;
+        }
+#endif
+
+        memcpy(leds, pFrame->leds, sizeof(leds));
+        frameQueue.Pop();
+        showContent();
+
+#if GIF_PREENCODED
+        uint32_t cbEncoded = 0;
+        for (uint8_t i = 0; (pStrip = WS2812Serial::instance(i)); i++)
+            cbEncoded += pStrip->encodedBytes();
+        uint8_t *pStore = (fCache && cbEncoded) ? EncodedCache::Store(key, ColorLut::Brightness(), cbEncoded) : nullptr;
+        if (pStore)
+        {
+            for (uint8_t i = 0; (pStrip = WS2812Serial::instance(i)); i++)
+            {
+                memcpy(pStore, pStrip->encodedFrame(), pStrip->encodedBytes());
+                pStore += pStrip->encodedBytes();
+            }
+        }
+#endif
+    }
+
+    // the brightness where the fade has got to by now
+    static void fade()
+    {
+        int32_t dt = micros() - timeFadeStart;
+        if (!fFading || dt < 0)
+            return;
+
+        uint32_t ms = dt / 1000;
+        if (ms >= msFade)
+        {
+            brightness = brightnessFade;
+            fFading = false;
+        }
+        else
+        {
+            brightness = brightnessFrom + ((int32_t)brightnessFade - brightnessFrom) * (int32_t)ms / msFade;
+        }
+        ColorLut::SetBrightness(brightness);
+    }
+
     void loop()
     {
-        packetSerial.update();
+        WS2812Serial::updateAll();
+        SerialRx::update();
+        fade();
+
+        // Playback waits for room rather than dropping its frame
+        Frame *pFrame = frameQueue.BeginPush();
+        if (pFrame && Playback::loop(pFrame->leds, pFrame->timeDue, pFrame->key))
+            pushFrame();
+
+        output();
 
         EVERY_N_MILLIS(200)
         {
             digitalWriteFast(pinLEDRxIndicator, LOW);
+
+            if (SerialRx::BadPackets() != cBadPacketsSeen)
+            {
+                cBadPacketsSeen = SerialRx::BadPackets();
+                Overlay::ShowWarning(LED_WARNING_MILLIS);
+            }
+        }
+
+        EVERY_N_MILLIS(10000)
+        {
+            static uint32_t cFramesReported = 0;
+            static uint32_t cElidedReported = 0;
+            if (cFramesShown + cFramesElided != cFramesReported)
+            {
+                WS2812Serial *pStrip = WS2812Serial::instance(0);
+                dbgprintf("Frames: %d shown, %d superseded, %d dropped, %d replaced at the strip, queue %d (max %d)\n",
+                          cFramesShown, cFramesSuperseded, cFramesDropped, pStrip ? pStrip->framesDropped() : 0,
+                          frameQueue.Count(), cQueueMax);
+                dbgprintf("Unchanged frames not sent: %d, %d per second\n",
+                          cFramesElided, (cFramesElided - cElidedReported) / 10);
+                cElidedReported = cFramesElided;
+#if GIF_PREENCODED
+                dbgprintf("Encoded frames: %d hits, %d misses\n", EncodedCache::Hits(), EncodedCache::Misses());
+#endif
+#if LED_TEMPORAL_DITHER
+                dbgprintf("Dithered refreshes: %d\n", cRefreshes);
+#endif
+                cFramesReported = cFramesShown + cFramesElided;
+            }
         }
     }
 
     void onPacketReceived(const uint8_t *buffer, size_t size)
     {
+        // SerialRx hands the packet over on the first update() after its
+        // delimiter arrives
+        uint32_t timeReceived = micros();
+
         if (size < sizeof(cmdUnknown))
         {
             // impossible packet doesn't even have room for checksum and command
             return;
         }
 
-        cmdUnknown *punk = (cmdUnknown *)buffer;
+        const cmdUnknown *punk = (const cmdUnknown *)buffer;
 
-        uint16_t checksum = punk->checksum;
-        punk->checksum = 0; // when packet checksum was calculated, these 2 bytes were 0
+        if (punk->whip != DipSwitch::getWhipNumber() && punk->whip != 255)
+        {
+            // not a message for us, so no need to check it. If it's the
+            // whip number that's garbled we lose a packet that was garbled
+            // anyway, or catch it below.
+            return;
+        }
 
-        if (checksum != calcCRC16(buffer, size))
+        if (!Checksum::Verify(buffer, size))
         {
             // packet garbled
             dbgprintf("garbled packet. Size was %d\n", size);
+            Overlay::ShowWarning(LED_WARNING_MILLIS);
             return;
         }
 
         digitalWriteFast(pinLEDRxIndicator, HIGH);
 
-        if (punk->whip != DipSwitch::getWhipNumber() && punk->whip != 255)
-        {
-            // not a message for us
-            return;
-        }
-
         switch (punk->chCommand)
         {
         case 'c':
         {
             cmdSetWhipColor *pSetWhipColor = (cmdSetWhipColor *)buffer;
-            FastLED.showColor(pSetWhipColor->rgb);
+            Playback::Stop();
+            Frame *pFrame = beginFrame();
+            if (pFrame)
+            {
+                fillFrame(pFrame, pSetWhipColor->rgb);
+                endFrame(pFrame, punk, timeReceived);
+            }
         }
         break;
 
         case 'b':
         {
-
+            // output() shows the new brightness, with the bar over it for a
+            // moment, on the next frame or between frames if none is coming
             cmdSetBrightness *pSetBrightness = (cmdSetBrightness *)buffer;
+            fFading = false;
             if (brightness != pSetBrightness->brightness)
             {
                 brightness = pSetBrightness->brightness;
-                FastLED.setBrightness(128);
-                int ixBrightness = map(brightness, 0, 255, 0, NUM_LEDS);
-                for (int i = 0; i < ixBrightness; i++)
-                {
-                    leds[i] = CRGB::White;
-                }
-                for (int i = ixBrightness; i < NUM_LEDS; i++)
-                {
-                    leds[i] = CRGB::Black;
-                }
-                FastLED.show();
-                FastLED.delay(200);
-                FastLED.setBrightness(pSetBrightness->brightness);
+                ColorLut::SetBrightness(brightness);
+                Overlay::ShowBar(brightness, LED_BAR_MILLIS);
+            }
+        }
+        break;
+
+        case 'd':
+        {
+            cmdFadeBrightness *pFade = (cmdFadeBrightness *)buffer;
+            if (pFade->brightness != (fFading ? brightnessFade : brightness))
+            {
+                brightnessFrom = brightness;
+                brightnessFade = pFade->brightness;
+                timeFadeStart = deadline(punk, timeReceived);
+                msFade = pFade->fadeMillis;
+                fFading = true;
+                Overlay::ShowBar(brightnessFade, LED_BAR_MILLIS);
             }
         }
         break;
 
         case 'g':
         {
+            Playback::Stop();
+            Frame *pFrame = beginFrame();
+            if (!pFrame)
+                break;
+
             if (DipSwitch::getWhipNumber() <= 23)
             {
-                static uint16_t iGifLoaded = 0;
-
                 cmdShowGIFFrame *pShowGIFFrame = (cmdShowGIFFrame *)buffer;
 
-                if (iGifLoaded != pShowGIFFrame->iGifNumber)
-                {
-                    Gif::LoadGif(iGifLoaded = pShowGIFFrame->iGifNumber);
-                    dbgprintf("Loading gif number %d\n", pShowGIFFrame->iGifNumber);
-                }
-                Gif::GetFrame(pShowGIFFrame->frame, leds);
-                FastLED.show();
+                // starts loading a new GIF in the background (Gif::loop); until
+                // it's ready we keep playing the previous one
+                Gif::LoadGifAsync(pShowGIFFrame->iGifNumber);
+                pFrame->key = Gif::GetFrame(pShowGIFFrame->frame, pFrame->leds);
             }
             else
             {
-                FastLED.showColor(CRGB::Red);
+                fillFrame(pFrame, CRGB::Red);
             }
+            endFrame(pFrame, punk, timeReceived);
             break;
         }
 
-        case 'i':
+        case 'p':
         {
-            uint8_t whip = DipSwitch::getWhipNumber();
+            cmdPrepareGIF *pPrepareGIF = (cmdPrepareGIF *)buffer;
+            Gif::Prefetch(pPrepareGIF->iGifNumber);
+            break;
+        }
 
-            for (int i = 0; i < NUM_LEDS; i++)
-                leds[i] = CRGB::Black;
+        case 's':
+        {
+            // the switch itself happens when cmdShowGIFFrame names the new GIF,
+            // or when Playback reaches the frame; this hurries it along if it
+            // isn't ready yet
+            cmdCommitGIF *pCommitGIF = (cmdCommitGIF *)buffer;
+            Gif::HurryPrefetch(pCommitGIF->iGifNumber);
+            Playback::OnCommit(pCommitGIF->iGifNumber, pCommitGIF->frame);
+            break;
+        }
 
-            for (int i = 0; i < 5; i++)
+        case 't':
+        {
+            if (DipSwitch::getWhipNumber() <= 23)
             {
-                for (int led = i * 20; led < (i + 1) * 20 - 3; led++)
-                {
-                    if (whip & 0x01)
-                        leds[led] = CRGB::White;
-                }
-                for (int led = (i + 1) * 20 - 3; led < (i + 1) * 20; led++)
-                {
-                    leds[led] = CRGB::Red;
-                }
-                whip >>= 1;
+                Playback::OnBeacon((cmdGIFBeacon *)buffer);
+            }
+            else if (Frame *pFrame = beginFrame())
+            {
+                fillFrame(pFrame, CRGB::Red);
+                endFrame(pFrame, punk, timeReceived);
             }
+            break;
+        }
+
+        case 'i':
+        {
+            uint8_t whip = DipSwitch::getWhipNumber();
+            Playback::Stop();
+            Frame *pFrame = beginFrame();
+            if (!pFrame)
+                break;
+
+            fillFrame(pFrame, CRGB::Black);
+            Overlay::DrawIdentify(pFrame->leds, whip, CRGB::White, CRGB::Red);
 
-            FastLED.show();
+            endFrame(pFrame, punk, timeReceived);
             break;
         }
 
@@ -155,14 +588,16 @@ namespace Led
             // Flappy Bird game state - render this whip's column
             cmdFlappyState *pFlappy = (cmdFlappyState *)buffer;
             uint8_t whipNum = DipSwitch::getWhipNumber();
+            Playback::Stop();
 
-            if (whipNum < FLAPPY_PHYSICAL_WIDTH)
+            Frame *pFrame;
+            if (whipNum < FLAPPY_PHYSICAL_WIDTH && (pFrame = beginFrame()))
             {
                 // Buffer for RGB data (110 LEDs * 3 bytes)
                 uint8_t rgbBuffer[FLAPPY_PHYSICAL_HEIGHT * 3];
 
                 // Render just this whip's column
-                renderFlappyColumn(
+                renderFlappyColumnSpans(
                     whipNum,
                     pFlappy->gameState,
                     pFlappy->birdY,
@@ -174,15 +609,15 @@ namespace Led
                     pFlappy->flashWhip,
                     rgbBuffer);
 
-                // Copy RGB buffer to FastLED array
+                // Copy RGB buffer to the frame
                 for (int i = 0; i < FLAPPY_PHYSICAL_HEIGHT; i++)
                 {
-                    leds[i].r = rgbBuffer[i * 3];
-                    leds[i].g = rgbBuffer[i * 3 + 1];
-                    leds[i].b = rgbBuffer[i * 3 + 2];
+                    pFrame->leds[i].r = rgbBuffer[i * 3];
+                    pFrame->leds[i].g = rgbBuffer[i * 3 + 1];
+                    pFrame->leds[i].b = rgbBuffer[i * 3 + 2];
                 }
 
-                FastLED.show();
+                endFrame(pFrame, punk, timeReceived);
             }
             break;
         }
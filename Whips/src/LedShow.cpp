@@ -1,15 +1,45 @@
 #include <Arduino.h>
-#include <PacketSerial.h>
-#include <CRC16.h>
-#include <CRC.h>
 
 #include "Util.h"
 #include "IR.h"
 #include "LedShow.h"
 #include "Commands.h"
 #include "Gif.h"
+#include "Catalog.h"
 #include "Flappy.h"
 
+// How far ahead of a GIF switch the commit goes out. Any whip that hasn't
+// finished prefetching the new GIF finishes it in this time, so a press of
+// nextImage takes at least this long to show.
+#define GIF_COMMIT_LEAD_MS 1000
+
+// nextImage presses that come while a switch is already under way (or before
+// the next GIF is picked) wait their turn, up to this many
+#define GIF_SWITCHES_QUEUED_MAX 4
+
+// With GIF_AUTONOMOUS the whips play GIFs from their own clocks and the DOM
+// sends a cmdGIFBeacon every GIF_BEACON_MS to keep them in step; otherwise
+// it sends a cmdShowGIFFrame for every frame. Opt in with
+// -DGIF_AUTONOMOUS=1; the visualizer env only follows cmdShowGIFFrame.
+#ifndef GIF_AUTONOMOUS
+#define GIF_AUTONOMOUS 0
+#endif
+#define GIF_BEACON_MS 1000
+
+// Presentation deadline for commands that change what's shown: long enough
+// for the last whip in the chain to receive and render one. Whips hold the
+// result in their frame queue until then (SerialRx's ring keeps receiving
+// meanwhile), so it must stay well under the time the queue's 4 frames
+// cover at the fastest frame rate sent, a Flappy frame every
+// FLAPPY_FRAME_MS; more and frames are dropped for want of room.
+#define SHOW_HOLD_MICROS 150
+
+// A brightness change fades in over BRIGHTNESS_FADE_MS on every whip. The
+// level is sent again every BRIGHTNESS_KEEPALIVE_MS in case a whip missed
+// it or has rebooted since.
+#define BRIGHTNESS_FADE_MS 300
+#define BRIGHTNESS_KEEPALIVE_MS 2000
+
 namespace LedShow
 {
     // brightness levels 0-19
@@ -21,8 +51,6 @@ namespace LedShow
     uint8_t ixBrightness = 0;
     bool fWriteEEPROM = false;
 
-    PacketSerial packetSerial;
-
     enum Mode
     {
         gif,
@@ -34,11 +62,58 @@ namespace LedShow
     // Moved to namespace scope so onButtonPress can access it
     static Mode modeCurrent = gif;
 
+    // how long each frame of a GIF is shown, from the catalog
+    struct Timeline
+    {
+        int ixGif;
+        uint16_t cFrames; // 0 if unknown: every frame gets GIF_DEFAULT_DELAY_MS
+        uint16_t rgDelays[MAX_FRAMES];
+
+        void Load(int ixGifNumber)
+        {
+            const Catalog::Entry *pEntry = Catalog::Find(ixGifNumber);
+            ixGif = ixGifNumber;
+            cFrames = (pEntry && Catalog::GetDelays(pEntry, rgDelays)) ? pEntry->cFrames : 0;
+        }
+
+        // frame counts up forever; the whips wrap it the same way
+        uint16_t Delay(uint32_t frame) const
+        {
+            if (cFrames == 0)
+                return GIF_DEFAULT_DELAY_MS;
+            return max(rgDelays[frame % cFrames], (uint16_t)GIF_MIN_DELAY_MS);
+        }
+    };
+
+    static Timeline rgTimelines[2];
+    static Timeline *pTimeline = &rgTimelines[0];     // the GIF being shown
+    static Timeline *pTimelineNext = &rgTimelines[1]; // the one being prefetched
+
+    // the GIF the whips are prefetching (0 if none), and when we switch to it
+    static int ixGifNext = 0;
+    static bool fSwitchPending = false;
+    static uint32_t frameSwitch = 0;
+    static uint8_t cSwitchesQueued = 0; // presses waiting for the one pending
+
+    // switches to the prefetched GIF once every whip has had time to get it
+    // ready; false if there's none to switch to yet, or a switch is pending
+    static bool ScheduleSwitch(uint32_t frame)
+    {
+        if (ixGifNext == 0 || fSwitchPending)
+            return false;
+
+        fSwitchPending = true;
+        uint32_t msLead = 0;
+        for (frameSwitch = frame; msLead < GIF_COMMIT_LEAD_MS || frameSwitch - frame < 2; frameSwitch++)
+            msLead += pTimeline->Delay(frameSwitch);
+        dbgprintf("switching to gif %d at frame %d\n", ixGifNext, frameSwitch);
+        return true;
+    }
+
     void setup()
     {
         dbgprintf("In LedShow.Setup\n");
-        Serial1.begin(2000000);
-        packetSerial.setStream(&Serial1);
+        TxQueue::setup(2000000);
         ixBrightness = EEPROM.read(0);
         if (ixBrightness > 19)
         {
@@ -52,7 +127,7 @@ namespace LedShow
     {
         static int ixGif = 1;
         static CRGB rgbSolid = CRGB::Black;
-        static int gifDelay = 40;
+        static uint32_t frame = 0;
 
         if (op != IR::noop)
             dbgprintf("LedShow::op is %d\n", op);
@@ -71,23 +146,10 @@ namespace LedShow
         case IR::nextImageSuggested:
 
             modeCurrent = gif;
+            if (!ScheduleSwitch(frame) && cSwitchesQueued < GIF_SWITCHES_QUEUED_MAX)
             {
-                bool bDone = false;
-                while (!bDone)
-                {
-                    ixGif++;
-
-                    // try to load that GIF to see if it exists and to get its frame rate
-                    if (Gif::GetGifInfo(ixGif, gifDelay))
-                    {
-                        dbgprintf("new gif number %d\n", ixGif);
-                        bDone = true;
-                    }
-                    else
-                    {
-                        ixGif = 0;
-                    }
-                }
+                cSwitchesQueued++;
+                dbgprintf("next gif queued (%d waiting)\n", cSwitchesQueued);
             }
 
             break;
@@ -141,15 +203,82 @@ namespace LedShow
         switch (modeCurrent)
         {
         case gif:
+            // runs as each frame is due to be shown
             EVERY_N_MILLIS_I(timerName, 400)
             {
-                timerName.setPeriod(gifDelay);
+#if GIF_AUTONOMOUS
+                static uint32_t timeBeacon = 0;
+                bool fBeacon = millis() - timeBeacon >= GIF_BEACON_MS;
+#endif
 
+                if (fSwitchPending && (int32_t)(frame - frameSwitch) >= 0)
+                {
+#if GIF_AUTONOMOUS
+                    fBeacon = true; // the whips start the new GIF from it
+#endif
+                    ixGif = ixGifNext;
+                    Timeline *pTimelineOld = pTimeline;
+                    pTimeline = pTimelineNext;
+                    pTimelineNext = pTimelineOld;
+                    ixGifNext = 0;
+                    fSwitchPending = false;
+                    dbgprintf("new gif number %d\n", ixGif);
+                }
+                if (pTimeline->ixGif != ixGif)
+                    pTimeline->Load(ixGif);
+
+                // first, so the timestamp is as close as can be to when it arrives
+#if GIF_AUTONOMOUS
+                if (fBeacon)
+                {
+                    cmdGIFBeacon beacon(255, frame, ixGif, micros());
+                    SendPacket(&beacon, TxQueue::priFrame);
+                    timeBeacon = millis();
+                }
+#else
                 static cmdShowGIFFrame p3(255, 0, 1);
-                static uint32_t frame = 0;
-                p3.frame = frame++;
+                p3.holdMicros = SHOW_HOLD_MICROS;
+                p3.frame = frame;
                 p3.iGifNumber = ixGif;
-                SendPacket(&p3, packetSerial);
+                SendPacket(&p3, TxQueue::priFrame);
+#endif
+
+                if (ixGifNext == 0)
+                {
+                    // pick the one after this and have the whips start loading it now
+                    const Catalog::Entry *pEntry = Catalog::Next(ixGif);
+                    if (pEntry)
+                    {
+                        ixGifNext = pEntry->ixGifNumber;
+                        pTimelineNext->Load(ixGifNext);
+                        cmdPrepareGIF pPrepare(255, ixGifNext);
+                        SendPacket(&pPrepare, TxQueue::priControl);
+                    }
+                }
+
+                // a press that came while the last switch was pending
+                if (cSwitchesQueued > 0 && ScheduleSwitch(frame + 1))
+                    cSwitchesQueued--;
+
+                if (fSwitchPending)
+                {
+                    cmdCommitGIF pCommit(255, frameSwitch, ixGifNext);
+                    SendPacket(&pCommit, TxQueue::priControl);
+                }
+
+                // nothing more to send until this frame's delay is up
+                timerName.setPeriod(pTimeline->Delay(frame));
+                frame++;
+            }
+
+            // in case a whip missed it, or has rebooted since
+            EVERY_N_MILLIS(1000)
+            {
+                if (ixGifNext != 0 && !fSwitchPending)
+                {
+                    cmdPrepareGIF pPrepare(255, ixGifNext);
+                    SendPacket(&pPrepare, TxQueue::priControl);
+                }
             }
             break;
 
@@ -157,7 +286,8 @@ namespace LedShow
             EVERY_N_MILLIS(40)
             {
                 cmdSetWhipColor p4(255, rgbSolid);
-                SendPacket(&p4, packetSerial);
+                p4.holdMicros = SHOW_HOLD_MICROS;
+                SendPacket(&p4, TxQueue::priFrame);
             }
             break;
 
@@ -165,7 +295,8 @@ namespace LedShow
             EVERY_N_MILLIS(40)
             {
                 cmdSelfIdentify p5;
-                SendPacket(&p5, packetSerial);
+                p5.holdMicros = SHOW_HOLD_MICROS;
+                SendPacket(&p5, TxQueue::priFrame);
             }
             break;
 
@@ -180,24 +311,28 @@ namespace LedShow
                 } else {
                     cmdFlappyState flappyState;
                     flappyGame.getState(&flappyState);
-                    SendPacket(&flappyState, packetSerial);
+                    flappyState.holdMicros = SHOW_HOLD_MICROS;
+                    SendPacket(&flappyState, TxQueue::priFrame);
                 }
             }
             break;
         }
 
-        EVERY_N_MILLIS(100)
+        static uint8_t ixBrightnessSent = 0;
+        static uint32_t timeBrightnessSent = 0;
+        if (ixBrightness > 0 && ixBrightness < 20 &&
+            (ixBrightness != ixBrightnessSent || millis() - timeBrightnessSent >= BRIGHTNESS_KEEPALIVE_MS))
         {
-            if (ixBrightness > 0 && ixBrightness < 20)
-            {
-                cmdSetBrightness p2(255, rgBrightness[ixBrightness]);
-                SendPacket(&p2, packetSerial);
+            cmdFadeBrightness p2(255, rgBrightness[ixBrightness], BRIGHTNESS_FADE_MS);
+            p2.holdMicros = SHOW_HOLD_MICROS;
+            SendPacket(&p2, ixBrightness != ixBrightnessSent ? TxQueue::priControl : TxQueue::priKeepalive);
+            ixBrightnessSent = ixBrightness;
+            timeBrightnessSent = millis();
 
-                if (fWriteEEPROM)
-                {
-                    EEPROM.write(0, ixBrightness);
-                    fWriteEEPROM = false;
-                }
+            if (fWriteEEPROM)
+            {
+                EEPROM.write(0, ixBrightness);
+                fWriteEEPROM = false;
             }
         }
     }
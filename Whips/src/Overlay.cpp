@@ -0,0 +1,112 @@
+#include <Arduino.h>
+
+#include "Overlay.h"
+
+// the warning is on for half of each period
+#define OVERLAY_BLINK_MILLIS 250
+#define OVERLAY_WARNING_LEDS 3
+
+namespace Overlay
+{
+    enum
+    {
+        kindBar,
+        kindIdentify,
+        kindWarning,
+        ckind
+    };
+
+    bool rgfActive[ckind] = {};
+    uint32_t rgtimeEnd[ckind];
+    uint8_t brightnessBar = 0;
+    uint8_t whipIdentify = 0;
+
+    static void start(int kind, uint32_t durationMillis)
+    {
+        rgfActive[kind] = true;
+        rgtimeEnd[kind] = millis() + durationMillis;
+    }
+
+    void ShowBar(uint8_t brightness, uint32_t durationMillis)
+    {
+        brightnessBar = brightness;
+        start(kindBar, durationMillis);
+    }
+
+    void ShowIdentify(uint8_t whip, uint32_t durationMillis)
+    {
+        whipIdentify = whip;
+        start(kindIdentify, durationMillis);
+    }
+
+    void ShowWarning(uint32_t durationMillis)
+    {
+        start(kindWarning, durationMillis);
+    }
+
+    // drops the overlays that have run out; true if kind is still showing
+    static bool active(int kind, uint32_t now)
+    {
+        if (rgfActive[kind] && (int32_t)(now - rgtimeEnd[kind]) >= 0)
+            rgfActive[kind] = false;
+        return rgfActive[kind];
+    }
+
+    static bool blinkOn(uint32_t now)
+    {
+        return (now / OVERLAY_BLINK_MILLIS) & 1;
+    }
+
+    uint32_t State()
+    {
+        uint32_t now = millis();
+        uint32_t state = 0;
+        if (active(kindBar, now))
+            state |= 0x01 | (brightnessBar << 8);
+        if (active(kindIdentify, now))
+            state |= 0x02 | (whipIdentify << 16);
+        if (active(kindWarning, now))
+            state |= blinkOn(now) ? 0x04 : 0x08;
+        return state;
+    }
+
+    void Composite(CRGB *pleds)
+    {
+        uint32_t now = millis();
+        const CRGB rgbWhite(OVERLAY_LEVEL, OVERLAY_LEVEL, OVERLAY_LEVEL);
+        const CRGB rgbRed(OVERLAY_LEVEL, 0, 0);
+
+        if (active(kindIdentify, now))
+            DrawIdentify(pleds, whipIdentify, rgbWhite, rgbRed);
+
+        if (active(kindBar, now))
+        {
+            int cLit = map(brightnessBar, 0, 255, 0, NUM_LEDS);
+            for (int i = 0; i < cLit; i++)
+                pleds[i] = rgbWhite;
+        }
+
+        if (active(kindWarning, now) && blinkOn(now))
+        {
+            for (int i = NUM_LEDS - OVERLAY_WARNING_LEDS; i < NUM_LEDS; i++)
+                pleds[i] = rgbRed;
+        }
+    }
+
+    void DrawIdentify(CRGB *pleds, uint8_t whip, const CRGB &rgbWhite, const CRGB &rgbRed)
+    {
+        for (int i = 0; i < 5; i++)
+        {
+            for (int led = i * 20; led < (i + 1) * 20 - 3; led++)
+            {
+                if (whip & 0x01)
+                    pleds[led] = rgbWhite;
+            }
+            for (int led = (i + 1) * 20 - 3; led < (i + 1) * 20; led++)
+            {
+                pleds[led] = rgbRed;
+            }
+            whip >>= 1;
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <FastLED.h>
+
+/*
+ * Overlay draws timed indicators over whatever the whip is showing: the
+ * brightness bar, the identify stripes and a blinking warning. Each lasts
+ * for the time it was started with and then goes away on its own; starting
+ * one again replaces it, so there is at most one of each kind.
+ *
+ * Composite() draws them into a frame that has already been through
+ * ColorLut, at fixed levels whatever the brightness, just before it goes to
+ * the strip. Its lit LEDs replace the content's; the rest show the content
+ * through. State() changes whenever Composite() would draw something
+ * different, so Led knows to send the frame again.
+ */
+
+// level of the overlays' white, after ColorLut
+#define OVERLAY_LEVEL 128
+
+namespace Overlay
+{
+    // a bar from the base of the whip, as long as brightness is of 255
+    void ShowBar(uint8_t brightness, uint32_t durationMillis);
+
+    // the whip number in stripes (see DrawIdentify)
+    void ShowIdentify(uint8_t whip, uint32_t durationMillis);
+
+    // the tip of the whip blinks red
+    void ShowWarning(uint32_t durationMillis);
+
+    // 0 when nothing is showing
+    uint32_t State();
+
+    // the overlays showing now, drawn over pleds
+    void Composite(CRGB *pleds);
+
+    // Five groups of 20 LEDs, one for each bit of whip from the base up:
+    // white for a 1, with 3 red LEDs at the end of each group. A 0 leaves
+    // the LEDs as they are.
+    void DrawIdentify(CRGB *pleds, uint8_t whip, const CRGB &rgbWhite, const CRGB &rgbRed);
+}
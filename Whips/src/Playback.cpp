@@ -0,0 +1,159 @@
+#include <Arduino.h>
+
+#include "Util.h"
+#include "Gif.h"
+#include "DipSwitch.h"
+#include "Playback.h"
+
+// a beacon whose time is off by more than this resets the clock instead of
+// steering it, e.g. after a reboot of either end
+#define PLAYBACK_RELOCK_MICROS 20000
+
+// the most the clock will be steered, parts per million. Teensy crystals
+// are good to about 30.
+#define PLAYBACK_MAX_PPM 500
+
+// time for a beacon to arrive after the DOM timestamps it: every byte of
+// it, plus COBS overhead and delimiter, at 10 bits a byte at 2 Mbaud
+#define PLAYBACK_WIRE_MICROS ((sizeof(cmdGIFBeacon) + 2) * 5)
+
+// a frame due within this long is rendered now and queued until it's due
+#define PLAYBACK_LEAD_MICROS 200
+
+namespace Playback
+{
+    // DOM time = domRef + local time since localRef, scaled by 1 + ppm/10^6
+    bool fLocked = false;
+    uint32_t localRef = 0;
+    uint32_t domRef = 0;
+    int32_t ppm = 0;
+    uint32_t cRelocks = 0;
+
+    bool fPlaying = false;
+    uint16_t ixGif = 0;
+    uint32_t frame = 0;      // the frame due now
+    uint32_t frameStart = 0; // when it started, DOM micros
+    uint32_t frameShown = 0; // the last one rendered
+    bool fShown = false;
+
+    bool fCommitPending = false;
+    uint16_t ixGifCommit = 0;
+    uint32_t frameCommit = 0;
+
+    static uint32_t DomMicrosAt(uint32_t local)
+    {
+        int32_t dLocal = local - localRef;
+        return domRef + dLocal + (int32_t)((int64_t)dLocal * ppm / 1000000);
+    }
+
+    uint32_t DomMicros()
+    {
+        return DomMicrosAt(micros());
+    }
+
+    // A proportional-integral loop: each beacon takes out half of the phase
+    // error at once and a quarter of the rate error it implies, which
+    // settles in a handful of beacons without overshooting.
+    static void SteerClock(uint32_t timeDom, uint32_t local)
+    {
+        int32_t err = timeDom - DomMicrosAt(local);
+
+        if (!fLocked || abs(err) > PLAYBACK_RELOCK_MICROS)
+        {
+            if (fLocked)
+                dbgprintf("Playback clock off by %d us, relocking (%d relocks)\n", err, ++cRelocks);
+            fLocked = true;
+            localRef = local;
+            domRef = timeDom;
+            return;
+        }
+
+        int32_t dLocal = local - localRef;
+        if (dLocal > 0)
+        {
+            ppm += (int32_t)((int64_t)err * 1000000 / dLocal / 4);
+            ppm = constrain(ppm, -PLAYBACK_MAX_PPM, PLAYBACK_MAX_PPM);
+        }
+        domRef = DomMicrosAt(local) + err / 2;
+        localRef = local;
+    }
+
+    void OnBeacon(const cmdGIFBeacon *pBeacon)
+    {
+        SteerClock(pBeacon->timeMicros, micros() - PLAYBACK_WIRE_MICROS - DipSwitch::getHopMicros());
+
+        if (!fPlaying || ixGif != pBeacon->iGifNumber)
+            dbgprintf("Playing gif %d from frame %d (clock %d ppm)\n", pBeacon->iGifNumber, pBeacon->frame, ppm);
+
+        fPlaying = true;
+        ixGif = pBeacon->iGifNumber;
+        Gif::LoadGifAsync(ixGif);
+
+        // the beacon marks the exact start of its frame
+        frame = pBeacon->frame;
+        frameStart = pBeacon->timeMicros;
+        if (fCommitPending && (int32_t)(frame - frameCommit) >= 0)
+            fCommitPending = false;
+    }
+
+    void OnCommit(uint16_t ixGifNumber, uint32_t frame)
+    {
+        fCommitPending = true;
+        ixGifCommit = ixGifNumber;
+        frameCommit = frame;
+    }
+
+    void Stop()
+    {
+        fPlaying = false;
+        fShown = false;
+        fCommitPending = false;
+    }
+
+    bool loop(CRGB *leds, uint32_t &timeDue, uint32_t &key)
+    {
+        if (!fPlaying)
+            return false;
+
+        // step on to the frame due now, or about to be
+        uint32_t now = DomMicros() + PLAYBACK_LEAD_MICROS;
+        uint32_t delayMicros;
+        while ((int32_t)(now - frameStart) >= (int32_t)(delayMicros = Gif::GetFrameDelay(frame) * 1000))
+        {
+            frameStart += delayMicros;
+            frame++;
+
+            // a whip that missed the prefetch keeps playing the old one until
+            // the new one is loaded, then joins the others on the same frame
+            if (fCommitPending && (int32_t)(frame - frameCommit) >= 0 && Gif::IsCached(ixGifCommit))
+            {
+                ixGif = ixGifCommit;
+                fCommitPending = false;
+                Gif::LoadGifAsync(ixGif); // cached, so this switches right away
+            }
+        }
+
+        if (fShown && frame == frameShown)
+            return false;
+
+        key = Gif::GetFrame(frame, leds);
+
+        // shown when it is due, so every whip shows it at the same moment
+        uint32_t local = micros();
+        timeDue = local + (int32_t)(frameStart - DomMicrosAt(local));
+
+        frameShown = frame;
+        fShown = true;
+        return true;
+    }
+
+    bool NextFrameDue(uint32_t &timeDue)
+    {
+        if (!fPlaying || !fShown)
+            return false;
+        uint32_t frameNext = frameStart + Gif::GetFrameDelay(frameShown) * 1000;
+        uint32_t local = micros();
+        timeDue = local + (int32_t)(frameNext - DomMicrosAt(local));
+        return true;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <WS2812Serial.h>
+#define USE_WS2812SERIAL
+#include <FastLED.h>
+
+#include "Commands.h"
+
+/*
+ * GIF playback from the SUB's own clock (SUB only)
+ *
+ * Instead of a cmdShowGIFFrame for every frame, the DOM sends a
+ * cmdGIFBeacon about once a second: the GIF, the frame starting and the
+ * DOM's clock. Each SUB keeps a copy of the DOM's clock, phase-locked to
+ * the beacons and corrected for the difference between the two crystals,
+ * and steps through the frames on it using each frame's own delay. A lost
+ * packet no longer loses a frame, and the bus is nearly idle meanwhile.
+ */
+
+namespace Playback
+{
+    void OnBeacon(const cmdGIFBeacon *pBeacon);
+
+    // switch to ixGifNumber when the frame count reaches frame, or as soon
+    // after that as it is loaded
+    void OnCommit(uint16_t ixGifNumber, uint32_t frame);
+
+    // stop playing, because something else is being shown
+    void Stop();
+
+    // renders the frame due now, or shortly, into leds and returns true if
+    // it is a new one, with the micros() it should be shown at in timeDue
+    // and what Gif::GetFrame() said it was in key
+    bool loop(CRGB *leds, uint32_t &timeDue, uint32_t &key);
+
+    // the micros() the frame after the one loop() last rendered is due at,
+    // or false if not playing
+    bool NextFrameDue(uint32_t &timeDue);
+
+    // the DOM's micros(), as far as we can tell
+    uint32_t DomMicros();
+}
@@ -0,0 +1,150 @@
+#include <Arduino.h>
+#if defined(__IMXRT1062__)
+#include <DMAChannel.h>
+#endif
+
+#include "Util.h"
+#include "SerialRx.h"
+
+#define RING_MASK (SERIALRX_RING_BYTES - 1)
+static_assert((SERIALRX_RING_BYTES & RING_MASK) == 0, "SERIALRX_RING_BYTES must be a power of two");
+
+namespace SerialRx
+{
+    // aligned to its size for the DMA's circular addressing
+    uint8_t rgbRing[SERIALRX_RING_BYTES] __attribute__((aligned(SERIALRX_RING_BYTES)));
+    uint16_t ixStart = 0; // first byte of the packet being received
+    uint16_t ixScan = 0;  // next byte to look at for a delimiter
+    PacketHandler onPacket = nullptr;
+    uint32_t cBadPackets = 0;
+
+#if defined(__IMXRT1062__)
+    DMAChannel dma;
+
+    void setup(uint32_t baud, PacketHandler onPacketIn)
+    {
+        onPacket = onPacketIn;
+
+        // Serial1 is LPUART6. Let the core set up the pins and baud rate,
+        // then take the receiver away from its interrupt handler.
+        Serial1.begin(baud);
+        LPUART6_CTRL &= ~(LPUART_CTRL_RIE | LPUART_CTRL_ILIE);
+
+        dma.begin();
+        dma.source((volatile uint8_t &)LPUART6_DATA);
+        dma.destinationCircular(rgbRing, SERIALRX_RING_BYTES);
+        dma.transferCount(SERIALRX_RING_BYTES);
+        dma.triggerAtHardwareEvent(DMAMUX_SOURCE_LPUART6_RX);
+        dma.enable();
+
+        // ask for the DMA as soon as there is one byte in the FIFO
+        LPUART6_WATER &= ~LPUART_WATER_RXWATER(3);
+        LPUART6_BAUD |= LPUART_BAUD_RDMAE;
+    }
+
+    // where the DMA will write next
+    static uint16_t Head()
+    {
+        return ((uint32_t)dma.destinationAddress() - (uint32_t)rgbRing) & RING_MASK;
+    }
+#else
+    uint16_t ixFill = 0;
+
+    void setup(uint32_t baud, PacketHandler onPacketIn)
+    {
+        onPacket = onPacketIn;
+        Serial1.begin(baud);
+    }
+
+    // Stands in for the DMA, a packet at a time so each one is handled
+    // before the next is read
+    static uint16_t Head()
+    {
+        while (Serial1.available())
+        {
+            uint8_t b = Serial1.read();
+            rgbRing[ixFill] = b;
+            ixFill = (ixFill + 1) & RING_MASK;
+            if (b == 0)
+                break;
+        }
+        return ixFill;
+    }
+#endif
+
+    // Decodes COBS where it lies. Each code byte is followed by code - 1
+    // data bytes and stands for a zero after them, unless it is 0xFF or the
+    // last; the output never catches up with the input. Returns the decoded
+    // size, or 0 if it isn't valid.
+    static size_t DecodeCobs(uint8_t *pb, size_t cb)
+    {
+        size_t ixRead = 0;
+        size_t ixWrite = 0;
+        while (ixRead < cb)
+        {
+            uint8_t code = pb[ixRead++];
+            if (code == 0 || ixRead + code - 1 > cb)
+                return 0;
+            for (uint8_t i = 1; i < code; i++)
+                pb[ixWrite++] = pb[ixRead++];
+            if (code != 0xFF && ixRead < cb)
+                pb[ixWrite++] = 0;
+        }
+        return ixWrite;
+    }
+
+    // the packet from ixStart up to the delimiter at ixEnd
+    static void Dispatch(uint16_t ixEnd)
+    {
+        static uint8_t rgbWrapped[SERIALRX_MAX_PACKET];
+        uint16_t cb = (ixEnd - ixStart) & RING_MASK;
+        if (cb == 0)
+            return;
+        if (cb > SERIALRX_MAX_PACKET)
+        {
+            dbgprintf("packet too long. Size was %d\n", cb);
+            cBadPackets++;
+            return;
+        }
+
+        uint8_t *pb = &rgbRing[ixStart];
+        if (ixStart + cb > SERIALRX_RING_BYTES)
+        {
+            uint16_t cbFirst = SERIALRX_RING_BYTES - ixStart;
+            memcpy(rgbWrapped, pb, cbFirst);
+            memcpy(rgbWrapped + cbFirst, rgbRing, cb - cbFirst);
+            pb = rgbWrapped;
+        }
+
+        size_t cbPacket = DecodeCobs(pb, cb);
+        if (cbPacket == 0)
+        {
+            dbgprintf("bad COBS packet. Size was %d\n", cb);
+            cBadPackets++;
+            return;
+        }
+        onPacket(pb, cbPacket);
+    }
+
+    void update()
+    {
+        // only up to where the DMA was when we started, so a busy bus can't
+        // keep us here
+        uint16_t ixHead = Head();
+        while (ixScan != ixHead)
+        {
+            uint16_t ix = ixScan;
+            ixScan = (ixScan + 1) & RING_MASK;
+            if (rgbRing[ix] == 0)
+            {
+                Dispatch(ix);
+                ixStart = ixScan;
+            }
+        }
+    }
+
+    uint32_t BadPackets()
+    {
+        return cBadPackets;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * SerialRx receives the DOM's packets on the SUB (in place of PacketSerial).
+ *
+ * The LPUART behind Serial1 writes every byte into a ring buffer by DMA,
+ * with no interrupt per byte. update() looks for the COBS packet
+ * delimiters the DMA has written since last time, decodes each packet
+ * where it lies in the ring and hands it to the packet handler without
+ * copying it; only a packet that wraps around the end of the ring is
+ * copied out first. The handler may modify the packet, but it is gone
+ * once the handler returns.
+ *
+ * The ring holds SERIALRX_RING_BYTES (20ms at 2 Mbaud), so loop() can be
+ * that late without losing bytes, where the core's 64 byte buffer allowed
+ * 320us. Native builds without the DMA copy from Serial1 instead.
+ */
+
+#define SERIALRX_RING_BYTES 4096
+
+// longest encoded packet; anything longer is garbage and dropped
+#define SERIALRX_MAX_PACKET 256
+
+namespace SerialRx
+{
+    typedef void (*PacketHandler)(const uint8_t *buffer, size_t size);
+
+    void setup(uint32_t baud, PacketHandler onPacket);
+    void update();
+
+    // packets that were too long or not valid COBS
+    uint32_t BadPackets();
+}
@@ -0,0 +1,201 @@
+#include <Arduino.h>
+#include <PacketSerial.h>
+#include <WS2812Serial.h>
+#define USE_WS2812SERIAL
+#include <FastLED.h>
+#if defined(__IMXRT1062__)
+#include <DMAChannel.h>
+#endif
+
+#include "Util.h"
+#include "Checksum.h"
+#include "TxQueue.h"
+
+// COBS adds a byte every 254, plus one, plus the delimiter
+#define TXQUEUE_MAX_ENCODED (TXQUEUE_MAX_PACKET + TXQUEUE_MAX_PACKET / 254 + 2)
+
+namespace TxQueue
+{
+    struct Slot
+    {
+        uint8_t rgb[TXQUEUE_MAX_ENCODED];
+        uint16_t cb;     // 0 if free
+        uint8_t pri;
+        char chCommand;  // what it is, to find the one it replaces
+        uint8_t whip;
+        uint32_t seq;    // order it was queued in
+    };
+
+    Slot rgSlots[TXQUEUE_SLOTS];
+    Slot *pSending = nullptr;
+    uint32_t seqNext = 0;
+    uint32_t baudRate = 0;
+
+    uint32_t cPackets = 0;
+    uint32_t cCoalesced = 0;
+    uint32_t cDropped = 0;
+    uint32_t cbThisSecond = 0;
+    uint16_t permilleLast = 0; // of the link's capacity, the last whole second
+    uint16_t permillePeak = 0;
+
+#if defined(__IMXRT1062__)
+    DMAChannel dma;
+
+    static void StartHardware()
+    {
+        // Serial1 is LPUART6; the core sets it up, then we feed it by DMA
+        dma.begin();
+        dma.destination((volatile uint8_t &)LPUART6_DATA);
+        dma.triggerAtHardwareEvent(DMAMUX_SOURCE_LPUART6_TX);
+        dma.disableOnCompletion();
+        LPUART6_BAUD |= LPUART_BAUD_TDMAE;
+    }
+
+    static bool Busy()
+    {
+        return (DMA_ERQ & (1 << dma.channel)) != 0;
+    }
+
+    static void Transmit(const uint8_t *pb, uint16_t cb)
+    {
+        if ((uint32_t)pb >= 0x20200000u)
+            arm_dcache_flush((void *)pb, cb);
+        dma.sourceBuffer(pb, cb);
+        dma.enable();
+    }
+#else
+    // Native builds have no DMA: the packet is written in one go, and the
+    // link is busy for as long as it takes to go out
+    uint32_t timeSent = 0;
+    uint32_t microsSending = 0;
+
+    static void StartHardware()
+    {
+    }
+
+    static bool Busy()
+    {
+        return micros() - timeSent < microsSending;
+    }
+
+    static void Transmit(const uint8_t *pb, uint16_t cb)
+    {
+        Serial1.write(pb, cb);
+        timeSent = micros();
+        microsSending = (uint32_t)((uint64_t)cb * 10 * 1000000 / baudRate);
+    }
+#endif
+
+    void setup(uint32_t baud)
+    {
+        baudRate = baud;
+        Serial1.begin(baud);
+        StartHardware();
+    }
+
+    // starts the next packet if the link is free
+    static void Kick()
+    {
+        if (Busy())
+            return;
+        if (pSending)
+        {
+            pSending->cb = 0;
+            pSending = nullptr;
+        }
+
+        Slot *pNext = nullptr;
+        for (Slot &slot : rgSlots)
+        {
+            if (slot.cb != 0 && (!pNext || slot.pri < pNext->pri || (slot.pri == pNext->pri && (int32_t)(slot.seq - pNext->seq) < 0)))
+                pNext = &slot;
+        }
+        if (!pNext)
+            return;
+
+        pSending = pNext;
+        Transmit(pNext->rgb, pNext->cb);
+        cbThisSecond += pNext->cb;
+        cPackets++;
+    }
+
+    // the slot for a new packet: the queued one it replaces, a free one, or
+    // the newest of the lowest priority if that is below it
+    static Slot *FindSlot(char chCommand, uint8_t whip, Priority pri)
+    {
+        Slot *pFree = nullptr;
+        Slot *pVictim = nullptr;
+        for (Slot &slot : rgSlots)
+        {
+            if (&slot == pSending)
+                continue;
+            if (slot.cb == 0)
+            {
+                if (!pFree)
+                    pFree = &slot;
+                continue;
+            }
+            if (slot.chCommand == chCommand && slot.whip == whip)
+            {
+                cCoalesced++;
+                return &slot;
+            }
+            if (slot.pri > pri && (!pVictim || slot.pri > pVictim->pri || (slot.pri == pVictim->pri && (int32_t)(slot.seq - pVictim->seq) > 0)))
+                pVictim = &slot;
+        }
+
+        if (pFree)
+            return pFree;
+        cDropped++;
+        return pVictim;
+    }
+
+    void Send(uint8_t *pb, size_t cb, Priority pri)
+    {
+        if (cb < 4 || cb > TXQUEUE_MAX_PACKET)
+            return;
+
+        Checksum::Stamp(pb, cb);
+#ifdef VISUALIZER
+        visualize(pb, cb);
+#endif
+
+        // bytes 2 and 3 are the command and the whip
+        Slot *pSlot = FindSlot((char)pb[2], pb[3], pri);
+        if (pSlot)
+        {
+            uint16_t cbEncoded = COBS::encode(pb, cb, pSlot->rgb);
+            pSlot->rgb[cbEncoded++] = 0;
+            pSlot->pri = pri;
+            pSlot->chCommand = (char)pb[2];
+            pSlot->whip = pb[3];
+            // a replacement keeps its place in the queue
+            if (pSlot->cb == 0)
+                pSlot->seq = seqNext++;
+            pSlot->cb = cbEncoded;
+        }
+
+        Kick();
+    }
+
+    void loop()
+    {
+        Kick();
+
+        EVERY_N_MILLIS(1000)
+        {
+            // 10 bits a byte
+            permilleLast = (uint16_t)((uint64_t)cbThisSecond * 10 * 1000 / baudRate);
+            if (permilleLast > permillePeak)
+                permillePeak = permilleLast;
+            cbThisSecond = 0;
+        }
+
+        EVERY_N_MILLIS(10000)
+        {
+            dbgprintf("Link: %d.%d%% busy last second (peak %d.%d%%), %d packets, %d coalesced, %d dropped\n",
+                      permilleLast / 10, permilleLast % 10, permillePeak / 10, permillePeak % 10,
+                      cPackets, cCoalesced, cDropped);
+        }
+    }
+}
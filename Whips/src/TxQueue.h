@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * TxQueue sends the DOM's packets (in place of PacketSerial).
+ *
+ * Send() checksums and COBS-encodes a packet into one of TXQUEUE_SLOTS
+ * slots and returns at once; the LPUART behind Serial1 takes the bytes by
+ * DMA, one packet after another, so nothing waits for the wire. Queued
+ * packets go out highest priority first, then oldest first. A packet that
+ * is still queued when another of the same command for the same whip is
+ * sent is replaced by it, since only the latest one matters. When every
+ * slot is taken a new packet pushes out a lower priority one, or is
+ * dropped.
+ *
+ * How busy the link was each second, and the packet counts, are printed
+ * every 10 seconds.
+ */
+
+#define TXQUEUE_SLOTS 8
+
+// largest command, before encoding
+#define TXQUEUE_MAX_PACKET 64
+
+namespace TxQueue
+{
+    enum Priority
+    {
+        priFrame,     // what's on the whips now: frames, beacons, colors
+        priControl,   // getting ready for what's next
+        priKeepalive, // repeated anyway, like the brightness
+    };
+
+    void setup(uint32_t baud);
+    void loop();
+
+    // fills in the packet's checksum and queues it
+    void Send(uint8_t *pb, size_t cb, Priority pri);
+}
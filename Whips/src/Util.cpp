@@ -63,7 +63,7 @@ void dbgprintf(char const *pszFmt UNUSED_IN_RELEASE, ...)
 
             case 'x':
             case 'X':
-                snprintf(rgchTmp, sizeof(rgchTmp), "%lX", va_arg(argv, uint32_t));
+                snprintf(rgchTmp, sizeof(rgchTmp), "%lX", (unsigned long)va_arg(argv, uint32_t));
                 appendStr(rgchTmp);
                 break;
 
@@ -135,7 +135,10 @@ void dbgprintf(char const *pszFmt UNUSED_IN_RELEASE, ...)
 
 void visualize(uint8_t *buf, size_t cb)
 {
-#ifdef VISUALIZER
+#ifndef VISUALIZER
+    (void)buf;
+    (void)cb;
+#else
 
     Serial.print("V");
     Serial.print(cb);
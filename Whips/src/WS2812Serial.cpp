@@ -23,6 +23,9 @@
 
 #include "WS2812Serial.h"
 
+WS2812Serial *WS2812Serial::instances[8];
+uint8_t WS2812Serial::num_instances = 0;
+
 bool WS2812Serial::begin()
 {
 #if defined(__IMXRT1062__) // Teensy 3.x
@@ -225,14 +228,120 @@ bool WS2812Serial::begin()
 #endif 
 
 	dma->triggerAtHardwareEvent(hwtrigger);
+#if defined(KINETISK) || defined(__IMXRT1062__)
+	dma->attachInterrupt(dma_isr);
+#endif
 	memset(drawBuffer, 0, numled * 3);
+	bool known = false;
+	for (uint8_t i=0; i < num_instances; i++) {
+		if (instances[i] == this) known = true;
+	}
+	if (!known && num_instances < sizeof(instances) / sizeof(instances[0])) {
+		instances[num_instances++] = this;
+	}
 	return true;
 }
 
+bool WS2812Serial::busy()
+{
+	if (!dma) return false;
+	// prior DMA still in progress
+#if defined(KINETISK) || defined(__IMXRT1062__)
+	if ((DMA_ERQ & (1 << dma->channel))) return true;
+#elif defined(KINETISL)
+	if ((dma->CFG->DCR & DMA_DCR_ERQ)) return true;
+#endif
+	// the DMA finishes when the last byte is in the UART, so the frame
+	// is on the wire and then latching until show() would stop waiting
+	uint32_t microseconds_per_led = (config < 6) ? 30 : 40;
+	uint32_t min_elapsed = (numled * microseconds_per_led) + 300;
+	return (micros() - prior_micros) <= min_elapsed;
+}
+
+bool WS2812Serial::anyBusy()
+{
+	for (uint8_t i=0; i < num_instances; i++) {
+		if (instances[i]->busy()) return true;
+	}
+	return false;
+}
+
+bool WS2812Serial::anyWaiting()
+{
+	for (uint8_t i=0; i < num_instances; i++) {
+		if (instances[i]->waiting()) return true;
+	}
+	return false;
+}
+
+void WS2812Serial::updateAll()
+{
+	for (uint8_t i=0; i < num_instances; i++) {
+		instances[i]->update();
+	}
+}
+
 void WS2812Serial::show()
 {
-	uint32_t microseconds_per_led, bytes_per_led;
+	if (backBuffer) {
+		showAsync();
+		return;
+	}
+	waitForDMA();
+	// copy drawing buffer to frame buffer
+	encode();
+	transmit(frameBuffer);
+}
+
+void WS2812Serial::showAsync()
+{
+	if (!backBuffer) {
+		show();
+		return;
+	}
+	if (pending) frames_dropped++;
+	// the DMA may still be reading the buffer it was given last
+	uint8_t *fb = (sending == frameBuffer) ? backBuffer : frameBuffer;
+	encode(fb);
+	pending = fb;
+	update();
+}
+
+void WS2812Serial::update()
+{
+	if (!pending || busy()) return;
+	const uint8_t *fb = pending;
+	pending = nullptr;
+	transmit(fb);
+}
+
+void WS2812Serial::showEncoded(const uint8_t *encoded)
+{
+	if (backBuffer) {
+		if (pending) frames_dropped++;
+		pending = encoded;
+		update();
+		return;
+	}
+	waitForDMA();
+	transmit(encoded);
+}
 
+#if defined(KINETISK) || defined(__IMXRT1062__)
+// one handler for every strip's channel
+void WS2812Serial::dma_isr()
+{
+	for (uint8_t i=0; i < num_instances; i++) {
+		WS2812Serial *p = instances[i];
+		if (!(DMA_INT & (1 << p->dma->channel))) continue;
+		p->dma->clearInterrupt();
+		if (p->on_complete) p->on_complete(p);
+	}
+}
+#endif
+
+void WS2812Serial::waitForDMA()
+{
 	// wait if prior DMA still in progress
 #if defined(KINETISK)
 	while ((DMA_ERQ & (1 << dma->channel))) {
@@ -249,91 +358,16 @@ void WS2812Serial::show()
 	}
 	//Serial.println("After Yield");
 #endif
-	// copy drawing buffer to frame buffer
+}
+
+void WS2812Serial::transmit(const uint8_t *fb)
+{
+	uint32_t microseconds_per_led, bytes_per_led;
+
 	if (config < 6) {
-		// RGB
-		const uint8_t *p = drawBuffer;
-		const uint8_t *end = p + (numled * 3);
-		uint8_t *fb = frameBuffer;
-		while (p < end) {
-			uint8_t b = *p++;
-			uint8_t g = *p++;
-			uint8_t r = *p++;
-			uint32_t mult = brightness + 1;
-			b = (b * mult) >> 8;
-			g = (g * mult) >> 8;
-			r = (r * mult) >> 8;
-			uint32_t n=0;
-			switch (config) {
-			  case WS2812_RGB: n = (r << 16) | (g << 8) | b; break;
-			  case WS2812_RBG: n = (r << 16) | (b << 8) | g; break;
-			  case WS2812_GRB: n = (g << 16) | (r << 8) | b; break;
-			  case WS2812_GBR: n = (g << 16) | (b << 8) | r; break;
-			  case WS2812_BRG: n = (b << 16) | (r << 8) | g; break;
-			  case WS2812_BGR: n = (b << 16) | (g << 8) | r; break;
-			}
-			const uint8_t *stop = fb + 12;
-			do {
-				uint8_t x = 0x08;
-				if (!(n & 0x00800000)) x |= 0x07;
-				if (!(n & 0x00400000)) x |= 0xE0;
-				n <<= 2;
-				*fb++ = x;
-			} while (fb < stop);
-		}
 		microseconds_per_led = 30;
 		bytes_per_led = 12;
 	} else {
-		// RGBW
-		const uint8_t *p = drawBuffer;
-		const uint8_t *end = p + (numled * 4);
-		uint8_t *fb = frameBuffer;
-		while (p < end) {
-			uint8_t b = *p++;
-			uint8_t g = *p++;
-			uint8_t r = *p++;
-			uint8_t w = *p++;
-			uint32_t mult = brightness + 1;
-			b = (b * mult) >> 8;
-			g = (g * mult) >> 8;
-			r = (r * mult) >> 8;
-			w = (w * mult) >> 8;
-			uint32_t n=0;
-			switch (config) {
-			  case WS2812_RGBW: n = (r << 24) | (g << 16) | (b << 8) | w; break;
-			  case WS2812_RBGW: n = (r << 24) | (b << 16) | (g << 8) | w; break;
-			  case WS2812_GRBW: n = (g << 24) | (r << 16) | (b << 8) | w; break;
-			  case WS2812_GBRW: n = (g << 24) | (b << 16) | (r << 8) | w; break;
-			  case WS2812_BRGW: n = (b << 24) | (r << 16) | (g << 8) | w; break;
-			  case WS2812_BGRW: n = (b << 24) | (b << 16) | (r << 8) | w; break;
-			  case WS2812_WRGB: n = (w << 24) | (r << 16) | (g << 8) | b; break;
-			  case WS2812_WRBG: n = (w << 24) | (r << 16) | (b << 8) | g; break;
-			  case WS2812_WGRB: n = (w << 24) | (g << 16) | (r << 8) | b; break;
-			  case WS2812_WGBR: n = (w << 24) | (g << 16) | (b << 8) | r; break;
-			  case WS2812_WBRG: n = (w << 24) | (b << 16) | (r << 8) | g; break;
-			  case WS2812_WBGR: n = (w << 24) | (b << 16) | (g << 8) | r; break;
-			  case WS2812_RWGB: n = (r << 24) | (w << 16) | (g << 8) | b; break;
-			  case WS2812_RWBG: n = (r << 24) | (w << 16) | (b << 8) | g; break;
-			  case WS2812_GWRB: n = (g << 24) | (w << 16) | (r << 8) | b; break;
-			  case WS2812_GWBR: n = (g << 24) | (w << 16) | (b << 8) | r; break;
-			  case WS2812_BWRG: n = (b << 24) | (w << 16) | (r << 8) | g; break;
-			  case WS2812_BWGR: n = (b << 24) | (w << 16) | (g << 8) | r; break;
-			  case WS2812_RGWB: n = (r << 24) | (g << 16) | (w << 8) | b; break;
-			  case WS2812_RBWG: n = (r << 24) | (b << 16) | (w << 8) | g; break;
-			  case WS2812_GRWB: n = (g << 24) | (r << 16) | (w << 8) | b; break;
-			  case WS2812_GBWR: n = (g << 24) | (b << 16) | (w << 8) | r; break;
-			  case WS2812_BRWG: n = (b << 24) | (r << 16) | (w << 8) | g; break;
-			  case WS2812_BGWR: n = (b << 24) | (g << 16) | (w << 8) | r; break;
-			}
-			const uint8_t *stop = fb + 16;
-			do {
-				uint8_t x = 0x08;
-				if (!(n & 0x80000000)) x |= 0x07;
-				if (!(n & 0x40000000)) x |= 0xE0;
-				n <<= 2;
-				*fb++ = x;
-			} while (fb < stop);
-		}
 		microseconds_per_led = 40;
 		bytes_per_led = 16;
 	}
@@ -347,27 +381,30 @@ void WS2812Serial::show()
 		yield();
 	}
 	prior_micros = m;
+	sending = fb;
 	// start DMA transfer to update LEDs  :-)
 #if defined(KINETISK)
-	dma->sourceBuffer(frameBuffer, numled * bytes_per_led);
+	dma->sourceBuffer(fb, numled * bytes_per_led);
 	dma->transferSize(1);
 	dma->transferCount(numled * bytes_per_led);
 	dma->disableOnCompletion();
+	if (on_complete) dma->interruptAtCompletion();
 	dma->enable();
 #elif defined(KINETISL)
-	dma->CFG->SAR = frameBuffer;
+	dma->CFG->SAR = (void *)fb;
 	dma->CFG->DSR_BCR = 0x01000000;
 	dma->CFG->DSR_BCR = numled * bytes_per_led;
 	dma->CFG->DCR = DMA_DCR_ERQ | DMA_DCR_CS | DMA_DCR_SSIZE(1) |
 		DMA_DCR_SINC | DMA_DCR_DSIZE(1) | DMA_DCR_D_REQ;
 #elif defined(__IMXRT1062__)
 	// See if we need to muck with DMA cache...
-	if ((uint32_t)frameBuffer >= 0x20200000u)  arm_dcache_flush(frameBuffer, numled * bytes_per_led);
+	if ((uint32_t)fb >= 0x20200000u)  arm_dcache_flush((void *)fb, numled * bytes_per_led);
 	
-	dma->sourceBuffer(frameBuffer, numled * bytes_per_led);
+	dma->sourceBuffer(fb, numled * bytes_per_led);
 //	dma->transferSize(1);
 	dma->transferCount(numled * bytes_per_led);
 	dma->disableOnCompletion();
+	if (on_complete) dma->interruptAtCompletion();
 
 /*	Serial.printf("%x %x:", (uint32_t)dma, (uint32_t)dma->TCD);
 
@@ -63,9 +63,14 @@ class WS2812Serial {
 public:
 	constexpr WS2812Serial(uint16_t num, void *fb, void *db, uint8_t pin, uint8_t cfg) :
 		numled(num), pin(pin), config(cfg),
-		frameBuffer((uint8_t *)fb), drawBuffer((uint8_t *)db) {
+		frameBuffer((uint8_t *)fb), drawBuffer((uint8_t *)db), encoded((uint8_t *)fb) {
 	}
 	bool begin();
+	// A second frame buffer, the same size as the first. With it, show()
+	// works like showAsync().
+	void setBackBuffer(void *fb) {
+		backBuffer = (uint8_t *)fb;
+	}
 	void setPixel(uint32_t num, uint32_t color) {
 		if (num >= numled) return;
 		if (config < 6) {
@@ -91,7 +96,48 @@ public:
 		memset(drawBuffer, 0, numled * ((config < 6) ? 3 : 4));
 	} 	
 	void show();
+	// Encodes the frame into whichever frame buffer the DMA isn't reading
+	// and returns at once. The frame goes out when the strip is free, from
+	// showAsync() or a later update(). A frame still waiting then is
+	// replaced and counted in framesDropped(). Needs setBackBuffer().
+	void showAsync();
+	// starts the waiting frame, if any, once the last one has latched
+	void update();
+	bool waiting() const {
+		return pending != nullptr;
+	}
+	uint32_t framesDropped() const {
+		return frames_dropped;
+	}
+	// Called from the DMA interrupt once the last byte of a frame is in the
+	// UART; its frame buffer may be reused from then on. Teensy 3.x and 4.x.
+	void onComplete(void (*fn)(WS2812Serial *)) {
+		on_complete = fn;
+	}
+	void encode() {
+		encode(frameBuffer);
+	}
+	// send frame bytes encode() made earlier, e.g. kept from encodedFrame();
+	// like showAsync() if there is a back buffer
+	void showEncoded(const uint8_t *encoded);
+	// the frame bytes encoded last
+	const uint8_t *encodedFrame() const {
+		return encoded;
+	}
+	uint32_t encodedBytes() const {
+		return numled * ((config < 6) ? 12 : 16);
+	}
 	bool busy();
+	// true while any strip that has begun is still sending or latching a frame
+	static bool anyBusy();
+	// true while any strip has a frame waiting to start
+	static bool anyWaiting();
+	// update() for every strip
+	static void updateAll();
+	// the strips that have begun, in order; nullptr past the last
+	static WS2812Serial *instance(uint8_t i) {
+		return i < num_instances ? instances[i] : nullptr;
+	}
 	uint16_t numPixels() {
 		return numled;
 	}
@@ -118,14 +164,28 @@ public:
 		return (white << 24) | (red << 16) | (green << 8) | blue;
 	}
 private:
+	void encode(uint8_t *fb);
+	void waitForDMA();
+	void transmit(const uint8_t *fb);
+	static void dma_isr();
 	const uint16_t numled;
 	const uint8_t pin;
 	const uint8_t config;
 	uint8_t *frameBuffer;
 	uint8_t *drawBuffer;
+	const uint8_t *encoded;
+	uint8_t *backBuffer = nullptr;
+	const uint8_t *sending = nullptr;	// what the DMA was last given
+	const uint8_t *pending = nullptr;	// waiting for the strip
+	uint32_t frames_dropped = 0;
+	void (*on_complete)(WS2812Serial *) = nullptr;
 	DMAChannel *dma = nullptr;
 	uint32_t prior_micros = 0;
 	uint8_t brightness = 255;
+	uint8_t scale[256] = {};		// brightness for each color value
+	int16_t scale_brightness = -1;	// the brightness scale[] is for
+	static WS2812Serial *instances[8];
+	static uint8_t num_instances;
 	#if defined(__IMXRT1062__) // Teensy 3.x
 	IMXRT_LPUART_t *uart = nullptr; 
 	#endif
@@ -0,0 +1,121 @@
+/*  WS2812Serial - Non-blocking WS2812 LED Display Library
+    https://github.com/PaulStoffregen/WS2812Serial
+    Copyright (c) 2017 Paul Stoffregen, PJRC.COM, LLC
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+#include "WS2812Serial.h"
+
+// Where each color sent comes from in drawBuffer (blue 0, green 1, red 2,
+// white 3), two bits per color, first sent in the low bits
+#define ORDER(c0, c1, c2, c3) ((c0) | ((c1) << 2) | ((c2) << 4) | ((c3) << 6))
+#define B 0
+#define G 1
+#define R 2
+#define W 3
+static constexpr uint8_t color_order[30] = {
+	ORDER(R,G,B,0), ORDER(R,B,G,0), ORDER(G,R,B,0),	// RGB RBG GRB
+	ORDER(G,B,R,0), ORDER(B,R,G,0), ORDER(B,G,R,0),	// GBR BRG BGR
+	ORDER(R,G,B,W), ORDER(R,B,G,W), ORDER(G,R,B,W),	// RGBW RBGW GRBW
+	ORDER(G,B,R,W), ORDER(B,R,G,W), ORDER(B,G,R,W),	// GBRW BRGW BGRW
+	ORDER(W,R,G,B), ORDER(W,R,B,G), ORDER(W,G,R,B),	// WRGB WRBG WGRB
+	ORDER(W,G,B,R), ORDER(W,B,R,G), ORDER(W,B,G,R),	// WGBR WBRG WBGR
+	ORDER(R,W,G,B), ORDER(R,W,B,G), ORDER(G,W,R,B),	// RWGB RWBG GWRB
+	ORDER(G,W,B,R), ORDER(B,W,R,G), ORDER(B,W,G,R),	// GWBR BWRG BWGR
+	ORDER(R,G,W,B), ORDER(R,B,W,G), ORDER(G,R,W,B),	// RGWB RBWG GRWB
+	ORDER(G,B,W,R), ORDER(B,R,W,G), ORDER(B,G,W,R),	// GBWR BRWG BGWR
+};
+#undef B
+#undef G
+#undef R
+#undef W
+#undef ORDER
+
+// The 4 UART bytes for each LED data byte, first sent in the low byte.
+// Each UART byte carries 2 data bits, high bit first.
+static uint32_t expand[256];
+
+static void fill_expand()
+{
+	for (uint32_t n = 0; n < 256; n++) {
+		uint32_t word = 0;
+		for (uint32_t i = 0; i < 4; i++) {
+			uint32_t bits = n << (2 * i);
+			uint8_t x = 0x08;
+			if (!(bits & 0x80)) x |= 0x07;
+			if (!(bits & 0x40)) x |= 0xE0;
+			word |= (uint32_t)x << (8 * i);
+		}
+		expand[n] = word;
+	}
+}
+
+static inline void put_byte(uint8_t *fb, uint8_t n)
+{
+	uint32_t word = expand[n];
+	memcpy(fb, &word, 4);	// a single 32-bit store
+}
+
+// One loop per color order, so the order costs nothing per LED
+template <uint8_t config>
+static void encode_pixels(const uint8_t *p, uint8_t *fb, uint32_t numled, const uint8_t *scale)
+{
+	constexpr uint32_t channels = (config < 6) ? 3 : 4;
+	constexpr uint8_t order = color_order[config];
+	const uint8_t *end = p + numled * channels;
+	while (p < end) {
+		put_byte(fb + 0, scale[p[order & 3]]);
+		put_byte(fb + 4, scale[p[(order >> 2) & 3]]);
+		put_byte(fb + 8, scale[p[(order >> 4) & 3]]);
+		if (channels == 4) put_byte(fb + 12, scale[p[order >> 6]]);
+		p += channels;
+		fb += channels * 4;
+	}
+}
+
+typedef void (*encoder_t)(const uint8_t *, uint8_t *, uint32_t, const uint8_t *);
+static const encoder_t encoders[30] = {
+	encode_pixels<0>, encode_pixels<1>, encode_pixels<2>, encode_pixels<3>,
+	encode_pixels<4>, encode_pixels<5>, encode_pixels<6>, encode_pixels<7>,
+	encode_pixels<8>, encode_pixels<9>, encode_pixels<10>, encode_pixels<11>,
+	encode_pixels<12>, encode_pixels<13>, encode_pixels<14>, encode_pixels<15>,
+	encode_pixels<16>, encode_pixels<17>, encode_pixels<18>, encode_pixels<19>,
+	encode_pixels<20>, encode_pixels<21>, encode_pixels<22>, encode_pixels<23>,
+	encode_pixels<24>, encode_pixels<25>, encode_pixels<26>, encode_pixels<27>,
+	encode_pixels<28>, encode_pixels<29>,
+};
+
+// Expands drawBuffer into fb: brightness, color order, and 4 UART bytes per
+// LED data byte. Kept apart from show() so the host build can run and
+// benchmark it.
+void WS2812Serial::encode(uint8_t *fb)
+{
+	if (config >= 30) return;
+	if (!expand[0]) fill_expand();	// 0 never expands to 0
+	if (scale_brightness != brightness) {
+		uint32_t mult = brightness + 1;
+		for (uint32_t i = 0; i < 256; i++) {
+			scale[i] = (i * mult) >> 8;
+		}
+		scale_brightness = brightness;
+	}
+	encoders[config](drawBuffer, fb, numled, scale);
+	encoded = fb;
+}
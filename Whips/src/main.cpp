@@ -4,9 +4,11 @@
 #include "Util.h"
 #include "Led.h"
 #include "LedShow.h"
+#include "TxQueue.h"
 #include "DipSwitch.h"
 #include "SDCard.h"
 #include "Gif.h"
+#include "Catalog.h"
 #include "IR.h"
 #include "Button.h"
 
@@ -40,6 +42,9 @@ void setup()
     Led::setup();
   }
   Gif::setup();
+
+  if (domMode)
+    Catalog::setup();
 }
 
 void loop()
@@ -49,6 +54,7 @@ void loop()
     IR::Op op = IR::loop();
     LedShow::loop(op);
     Button::loop();
+    TxQueue::loop();
 
     EVERY_N_SECONDS(20)
     {
@@ -59,5 +65,6 @@ void loop()
   {
     DipSwitch::loop();
     Led::loop();
+    Gif::loop();
   }
 }
@@ -1,5 +1,11 @@
 #define pinLEDStrip 8
 
+// more strips, with -DLED_STRIPS=2..4; each must be a TX pin WS2812Serial
+// can drive (Serial4, Serial5, Serial6)
+#define pinLEDStrip2 17
+#define pinLEDStrip3 20
+#define pinLEDStrip4 24
+
 // Which SD Card are we using?
 // BUILTIN_SDCARD - for Teensy 4.1
 // 10 - when connected to external SD Card using SPI
@@ -0,0 +1,46 @@
+#pragma once
+
+/*
+ * Tiny timing helpers shared by the host benchmarks.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static inline uint64_t benchNanos()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Cycle counter where the CPU has one, nanoseconds otherwise
+static inline uint64_t benchCycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return benchNanos();
+#endif
+}
+
+// Keeps the optimizer from discarding a result
+static inline void benchKeep(const void *p)
+{
+    __asm__ __volatile__("" : : "g"(p) : "memory");
+}
+
+// Run fn() iterations times and return the average nanoseconds per call
+template <typename F>
+static double benchTime(uint32_t iterations, F fn)
+{
+    uint64_t start = benchNanos();
+    for (uint32_t i = 0; i < iterations; i++)
+        fn(i);
+    return (double)(benchNanos() - start) / iterations;
+}
@@ -0,0 +1,130 @@
+/*
+ * Packet checksum cost before and after the table-driven Checksum engine.
+ *
+ * The "before" CRC below is calcCRC16() from robtillaart/CRC with the
+ * defaults the firmware used (polynomial 0x8001, bit at a time), kept here
+ * as a reference, and the "before" check is what Led::onPacketReceived did
+ * with it: clear the checksum in the packet, CRC all of it, then look at
+ * the whip it's for.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "Checksum.h"
+
+// sizeof(cmdFlappyState), the packet the SUBs get most of
+#define PACKET_BYTES 26
+#define OUR_WHIP 5
+
+static uint16_t legacyCrc16(const uint8_t *array, uint16_t length)
+{
+    uint16_t crc = 0;
+    while (length--)
+    {
+        crc ^= ((uint16_t)*array++) << 8;
+        for (uint8_t i = 8; i; i--)
+        {
+            if (crc & (1 << 15))
+                crc = (crc << 1) ^ 0x8001;
+            else
+                crc <<= 1;
+        }
+    }
+    return crc;
+}
+
+static bool legacyAccept(uint8_t *packet, size_t cb)
+{
+    uint16_t checksum;
+    memcpy(&checksum, packet, 2);
+    memset(packet, 0, 2);
+    bool fOk = checksum == legacyCrc16(packet, cb);
+    memcpy(packet, &checksum, 2);
+    return fOk && (packet[3] == OUR_WHIP || packet[3] == 255);
+}
+
+static bool newAccept(const uint8_t *packet, size_t cb)
+{
+    if (packet[3] != OUR_WHIP && packet[3] != 255)
+        return false;
+    return Checksum::Verify(packet, cb);
+}
+
+// bytes per cycle of fn() over cb bytes, best of a few runs
+template <typename F>
+static double bytesPerCycle(size_t cb, uint32_t iterations, F fn)
+{
+    double best = 0;
+    for (int trial = 0; trial < 5; trial++)
+    {
+        uint64_t start = benchCycles();
+        for (uint32_t i = 0; i < iterations; i++)
+            fn(i);
+        double rate = (double)cb * iterations / (double)(benchCycles() - start);
+        if (rate > best)
+            best = rate;
+    }
+    return best;
+}
+
+int main()
+{
+    static uint8_t block[4096];
+    for (size_t i = 0; i < sizeof(block); i++)
+        block[i] = (uint8_t)rand();
+
+    // Same CRC as before, for every length
+    for (size_t cb = 0; cb <= 300; cb++)
+    {
+        if (legacyCrc16(block, cb) != Checksum::Crc16(block, cb))
+        {
+            printf("MISMATCH at %u bytes\n", (unsigned)cb);
+            return 1;
+        }
+    }
+    printf("table CRC16 matches calcCRC16 for 0-300 bytes\n");
+
+    uint16_t crc = 0;
+    double rLegacy = bytesPerCycle(sizeof(block), 200, [&](uint32_t)
+                                   { crc ^= legacyCrc16(block, sizeof(block)); benchKeep(&crc); });
+    double rTable = bytesPerCycle(sizeof(block), 200, [&](uint32_t)
+                                  { crc ^= Checksum::Crc16(block, sizeof(block)); benchKeep(&crc); });
+    printf("CRC16 of 4 KB      bitwise %6.3f bytes/cycle   table %6.3f bytes/cycle (%.1fx)\n",
+           rLegacy, rTable, rTable / rLegacy);
+
+    // one packet for us (broadcast) and one for another whip
+    uint8_t ours[PACKET_BYTES], theirs[PACKET_BYTES];
+    for (size_t i = 0; i < PACKET_BYTES; i++)
+        ours[i] = theirs[i] = (uint8_t)rand();
+    ours[2] = theirs[2] = 'f';
+    ours[3] = 255;
+    theirs[3] = OUR_WHIP + 1;
+    Checksum::Stamp(ours, PACKET_BYTES);
+    Checksum::Stamp(theirs, PACKET_BYTES);
+    if (!legacyAccept(ours, PACKET_BYTES) || !newAccept(ours, PACKET_BYTES) ||
+        legacyAccept(theirs, PACKET_BYTES) || newAccept(theirs, PACKET_BYTES))
+    {
+        printf("MISMATCH accepting packets\n");
+        return 1;
+    }
+
+    uint32_t cAccepted = 0;
+    double rLegacyOurs = bytesPerCycle(PACKET_BYTES, 100000, [&](uint32_t)
+                                       { cAccepted += legacyAccept(ours, PACKET_BYTES); benchKeep(ours); });
+    double rNewOurs = bytesPerCycle(PACKET_BYTES, 100000, [&](uint32_t)
+                                    { cAccepted += newAccept(ours, PACKET_BYTES); benchKeep(ours); });
+    double rLegacyTheirs = bytesPerCycle(PACKET_BYTES, 100000, [&](uint32_t)
+                                         { cAccepted += legacyAccept(theirs, PACKET_BYTES); benchKeep(theirs); });
+    double rNewTheirs = bytesPerCycle(PACKET_BYTES, 100000, [&](uint32_t)
+                                      { cAccepted += newAccept(theirs, PACKET_BYTES); benchKeep(theirs); });
+    benchKeep(&cAccepted);
+
+    printf("%d byte packet for us     before %6.3f bytes/cycle   after %6.3f bytes/cycle (%.1fx)\n",
+           PACKET_BYTES, rLegacyOurs, rNewOurs, rNewOurs / rLegacyOurs);
+    printf("%d byte packet for others before %6.3f bytes/cycle   after %6.3f bytes/cycle (%.1fx)\n",
+           PACKET_BYTES, rLegacyTheirs, rNewTheirs, rNewTheirs / rLegacyTheirs);
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * Compares the supersampling column renderer against the analytic
+ * span renderer: first checks they produce identical bytes over a sweep
+ * of game states, then times both per column.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "FlappyRender.h"
+
+struct FlappyArgs
+{
+    uint8_t gameState;
+    uint16_t birdY;
+    uint16_t score;
+    int16_t pipeX[3];
+    uint16_t pipeGapY[3];
+    int16_t scrollX;
+    uint8_t flashWhip;
+};
+
+typedef void (*ColumnRenderer)(uint8_t, uint8_t, uint16_t, uint16_t,
+                               int16_t, uint16_t, int16_t, uint16_t, int16_t, uint16_t,
+                               int16_t, uint8_t, uint8_t *);
+
+static void render(ColumnRenderer fn, uint8_t whip, const FlappyArgs &a, uint8_t *out)
+{
+    fn(whip, a.gameState, a.birdY, a.score,
+       a.pipeX[0], a.pipeGapY[0],
+       a.pipeX[1], a.pipeGapY[1],
+       a.pipeX[2], a.pipeGapY[2],
+       a.scrollX, a.flashWhip, out);
+}
+
+static FlappyArgs randomArgs(uint8_t gameState)
+{
+    FlappyArgs a;
+    a.gameState = gameState;
+    a.birdY = rand() % FLAPPY_VIRTUAL_HEIGHT;
+    a.score = (rand() % 4 == 0) ? rand() % 65536 : rand() % 200;
+    for (int i = 0; i < 3; i++)
+    {
+        a.pipeX[i] = (rand() % 4 == 0) ? -100 : (int16_t)(rand() % 120 - 12);
+        a.pipeGapY[i] = rand() % FLAPPY_VIRTUAL_HEIGHT;
+    }
+    a.scrollX = rand() % 260 - 140;
+    a.flashWhip = (rand() % 8 == 0) ? rand() % FLAPPY_PHYSICAL_WIDTH : 255;
+    return a;
+}
+
+static bool verify(const FlappyArgs &a)
+{
+    uint8_t ref[FLAPPY_PHYSICAL_HEIGHT * 3];
+    uint8_t out[FLAPPY_PHYSICAL_HEIGHT * 3];
+
+    for (int whip = 0; whip < FLAPPY_PHYSICAL_WIDTH; whip++)
+    {
+        render(renderFlappyColumn, whip, a, ref);
+        render(renderFlappyColumnSpans, whip, a, out);
+        if (memcmp(ref, out, sizeof(ref)) != 0)
+        {
+            printf("MISMATCH whip %d state %d birdY %d score %d pipes (%d,%d) (%d,%d) (%d,%d) scroll %d\n",
+                   whip, a.gameState, a.birdY, a.score,
+                   a.pipeX[0], a.pipeGapY[0], a.pipeX[1], a.pipeGapY[1], a.pipeX[2], a.pipeGapY[2],
+                   a.scrollX);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    srand(1);
+
+    // Exhaustive sweep of a single pipe and the bird over every position
+    uint32_t checked = 0;
+    for (int pipeX = -12; pipeX <= 100; pipeX++)
+    {
+        for (int gapY = 0; gapY < FLAPPY_VIRTUAL_HEIGHT; gapY += 7)
+        {
+            FlappyArgs a = {FLAPPY_STATE_PLAYING, (uint16_t)((pipeX * 13 + gapY) % FLAPPY_VIRTUAL_HEIGHT), 0,
+                            {(int16_t)pipeX, -100, -100}, {(uint16_t)gapY, 0, 0}, 0, 255};
+            if (!verify(a))
+                return 1;
+            checked++;
+        }
+    }
+
+    // Game over score scroll for a range of scores
+    for (int score = 0; score < 100000; score = score * 3 + 1)
+    {
+        for (int scrollX = -140; scrollX <= 100; scrollX++)
+        {
+            FlappyArgs a = {FLAPPY_STATE_GAMEOVER, 0, (uint16_t)score, {-100, -100, -100}, {0, 0, 0}, (int16_t)scrollX, 255};
+            if (!verify(a))
+                return 1;
+            checked++;
+        }
+    }
+
+    // Random states, including overlapping pipes and out-of-range values
+    for (int i = 0; i < 20000; i++)
+    {
+        if (!verify(randomArgs(rand() % 3)))
+            return 1;
+        checked++;
+    }
+
+    printf("renderFlappyColumnSpans matches renderFlappyColumn on %u states\n", checked);
+
+    // Timing
+    const int NUM_STATES = 256;
+    FlappyArgs playing[NUM_STATES], gameOver[NUM_STATES];
+    for (int i = 0; i < NUM_STATES; i++)
+    {
+        playing[i] = randomArgs(FLAPPY_STATE_PLAYING);
+        playing[i].flashWhip = 255;
+        gameOver[i] = randomArgs(FLAPPY_STATE_GAMEOVER);
+        gameOver[i].flashWhip = 255;
+    }
+
+    static uint8_t out[FLAPPY_PHYSICAL_HEIGHT * 3];
+    const uint32_t ITER = 200000;
+
+    struct
+    {
+        const char *name;
+        const FlappyArgs *states;
+    } cases[] = {{"playing", playing}, {"gameover", gameOver}};
+
+    for (auto &c : cases)
+    {
+        double tSuper = benchTime(ITER, [&](uint32_t i)
+                                  { render(renderFlappyColumn, i % FLAPPY_PHYSICAL_WIDTH, c.states[i % NUM_STATES], out); benchKeep(out); });
+        double tSpans = benchTime(ITER, [&](uint32_t i)
+                                  { render(renderFlappyColumnSpans, i % FLAPPY_PHYSICAL_WIDTH, c.states[i % NUM_STATES], out); benchKeep(out); });
+
+        printf("%-9s supersample %8.1f ns/column   spans %8.1f ns/column   speedup %.1fx\n",
+               c.name, tSuper, tSpans, tSuper / tSpans);
+    }
+
+    return 0;
+}
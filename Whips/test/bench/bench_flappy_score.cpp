@@ -0,0 +1,167 @@
+/*
+ * Game-over frame cost before and after the score glyph cache.
+ *
+ * The "before" renderer below is the original per-pixel score path,
+ * kept here as a reference: it decomposes the score into digits for
+ * every virtual pixel it tests. It draws from FlappyRender's own font.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "FlappyRender.h"
+
+static bool legacyIsScorePixel(int vx, int vy, uint16_t score, int16_t scrollX)
+{
+    const int SCALE_X = 3;
+    const int SCALE_Y = 47;
+    const int digitWidth = 5 * SCALE_X;
+    const int digitHeight = 7 * SCALE_Y;
+    const int digitSpacing = digitWidth / 2;
+    const int scoreY = (FLAPPY_VIRTUAL_HEIGHT - digitHeight) / 2;
+
+    int digits[5];
+    int numDigits = 0;
+    int tempScore = score;
+    if (tempScore == 0)
+    {
+        digits[0] = 0;
+        numDigits = 1;
+    }
+    else
+    {
+        while (tempScore > 0 && numDigits < 5)
+        {
+            digits[numDigits++] = tempScore % 10;
+            tempScore /= 10;
+        }
+        for (int i = 0; i < numDigits / 2; i++)
+        {
+            int tmp = digits[i];
+            digits[i] = digits[numDigits - 1 - i];
+            digits[numDigits - 1 - i] = tmp;
+        }
+    }
+
+    int totalWidth = numDigits * digitWidth + (numDigits - 1) * digitSpacing;
+    int relX = vx - scrollX;
+
+    if (relX < 0 || relX >= totalWidth)
+        return false;
+    if (vy < scoreY || vy >= scoreY + digitHeight)
+        return false;
+
+    int digitIndex = relX / (digitWidth + digitSpacing);
+    if (digitIndex >= numDigits)
+        return false;
+
+    int withinDigitX = relX - digitIndex * (digitWidth + digitSpacing);
+    if (withinDigitX >= digitWidth)
+        return false;
+
+    int fontX = withinDigitX / SCALE_X;
+    int fontY = (vy - scoreY) / SCALE_Y;
+
+    if (fontX >= 5 || fontY >= 7)
+        return false;
+
+    uint8_t row = flappyDigitFont[digits[digitIndex]][7 - 1 - fontY];
+    return (row >> (5 - 1 - fontX)) & 1;
+}
+
+// Full 24x110 game-over frame, supersampled the way FlappyRender did before the cache
+static void legacyGameOverFrame(uint16_t score, int16_t scrollX, uint8_t *rgbBuffer)
+{
+    for (int whip = 0; whip < FLAPPY_PHYSICAL_WIDTH; whip++)
+    {
+        for (int led = 0; led < FLAPPY_PHYSICAL_HEIGHT; led++)
+        {
+            int rSum = 0, gSum = 0, bSum = 0;
+            for (int dvx = 0; dvx < FLAPPY_SCALE; dvx++)
+            {
+                for (int dvy = 0; dvy < FLAPPY_SCALE; dvy++)
+                {
+                    int vx = whip * FLAPPY_SCALE + dvx;
+                    int vy = led * FLAPPY_SCALE + dvy;
+                    if (vy < FLAPPY_GROUND_HEIGHT)
+                    {
+                        rSum += FLAPPY_COLOR_GROUND_R;
+                        gSum += FLAPPY_COLOR_GROUND_G;
+                        bSum += FLAPPY_COLOR_GROUND_B;
+                    }
+                    else if (legacyIsScorePixel(vx, vy, score, scrollX))
+                    {
+                        rSum += 255;
+                        gSum += 255;
+                        bSum += 255;
+                    }
+                }
+            }
+            uint8_t *p = &rgbBuffer[(whip * FLAPPY_PHYSICAL_HEIGHT + led) * 3];
+            p[0] = rSum / 16;
+            p[1] = gSum / 16;
+            p[2] = bSum / 16;
+        }
+    }
+}
+
+static void cachedGameOverFrame(uint16_t score, int16_t scrollX, uint8_t *rgbBuffer)
+{
+    renderFlappyState(FLAPPY_STATE_GAMEOVER, 0, score, -100, 0, -100, 0, -100, 0, scrollX, 255, rgbBuffer);
+}
+
+static void spansGameOverFrame(uint16_t score, int16_t scrollX, uint8_t *rgbBuffer)
+{
+    for (int whip = 0; whip < FLAPPY_PHYSICAL_WIDTH; whip++)
+    {
+        renderFlappyColumnSpans(whip, FLAPPY_STATE_GAMEOVER, 0, score, -100, 0, -100, 0, -100, 0,
+                                scrollX, 255, &rgbBuffer[whip * FLAPPY_PHYSICAL_HEIGHT * 3]);
+    }
+}
+
+int main()
+{
+    static uint8_t ref[FLAPPY_PHYSICAL_WIDTH * FLAPPY_PHYSICAL_HEIGHT * 3];
+    static uint8_t out[FLAPPY_PHYSICAL_WIDTH * FLAPPY_PHYSICAL_HEIGHT * 3];
+
+    // Same pixels as before, for every score length and scroll position
+    uint32_t checked = 0;
+    for (int score = 0; score < 65536; score = score * 7 + 3)
+    {
+        for (int scrollX = -120; scrollX <= FLAPPY_VIRTUAL_WIDTH; scrollX += 3)
+        {
+            legacyGameOverFrame(score, scrollX, ref);
+            cachedGameOverFrame(score, scrollX, out);
+            if (memcmp(ref, out, sizeof(ref)) != 0)
+            {
+                printf("MISMATCH score %d scroll %d\n", score, scrollX);
+                return 1;
+            }
+            spansGameOverFrame(score, scrollX, out);
+            if (memcmp(ref, out, sizeof(ref)) != 0)
+            {
+                printf("MISMATCH (spans) score %d scroll %d\n", score, scrollX);
+                return 1;
+            }
+            checked++;
+        }
+    }
+    printf("cached score renderer matches the original on %u game-over frames\n", checked);
+
+    // A scroll pass of a 3 digit score, one frame per scroll step
+    const uint16_t score = 427;
+    const uint32_t ITER = 2000;
+
+    double tLegacy = benchTime(ITER, [&](uint32_t i)
+                               { legacyGameOverFrame(score, FLAPPY_VIRTUAL_WIDTH - (int)(i % 200), out); benchKeep(out); });
+    double tCached = benchTime(ITER, [&](uint32_t i)
+                               { cachedGameOverFrame(score, FLAPPY_VIRTUAL_WIDTH - (int)(i % 200), out); benchKeep(out); });
+    double tSpans = benchTime(ITER, [&](uint32_t i)
+                              { spansGameOverFrame(score, FLAPPY_VIRTUAL_WIDTH - (int)(i % 200), out); benchKeep(out); });
+
+    printf("game-over frame  before %8.1f us   glyph cache %8.1f us (%.1fx)   spans %8.1f us (%.1fx)\n",
+           tLegacy / 1000, tCached / 1000, tLegacy / tCached, tSpans / 1000, tLegacy / tSpans);
+
+    return 0;
+}
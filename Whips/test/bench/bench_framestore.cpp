@@ -0,0 +1,157 @@
+/*
+ * Measures FrameStore on real animations: decodes each GIF (bench_gif.h),
+ * loads every whip's strip of it, checks every frame decodes back exactly,
+ * and reports the compression ratio and GetFrame() time for frames played
+ * in order and picked at random. The Makefile builds it at several
+ * keyframe intervals to compare them with FRAMESTORE_KEYFRAME_INTERVAL.
+ *
+ *     bench_framestore [dir-with-gif-files]
+ */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "bench_gif.h"
+#include "FrameStore.h"
+
+#ifndef GIF_DIR
+#define GIF_DIR "../../../Whips-Art/Hex/experiment"
+#endif
+
+struct Totals
+{
+    uint64_t cbRaw = 0;
+    uint64_t cbStored = 0;
+    double nsSequentialMax = 0;
+    double nsRandomMax = 0;
+};
+
+static bool benchFile(const std::string &path, Totals &totals)
+{
+    BenchGif gif;
+    if (!benchLoadGif(path, gif, MAX_FRAMES))
+    {
+        printf("%s: can't decode\n", path.c_str());
+        return false;
+    }
+    if (gif.width != NUM_LEDS)
+    {
+        printf("%s: %d pixels wide, not %d LEDs\n", path.c_str(), gif.width, NUM_LEDS);
+        return false;
+    }
+
+    const uint16_t *delays = gif.delays.data();
+    uint32_t cFrames = gif.delays.size();
+    uint32_t cbFrame = NUM_LEDS * 3;
+    uint32_t cbCanvas = cbFrame * gif.height;
+
+    uint64_t cbRaw = 0, cbStored = 0;
+    double nsSequential = 0, nsRandom = 0;
+    uint8_t rgb[NUM_LEDS * 3];
+    FrameStore store;
+
+    for (int whip = 0; whip < gif.height; whip++)
+    {
+        // this whip's row of frame i
+        auto frame = [&](uint32_t i) { return &gif.frames[i * cbCanvas + whip * cbFrame]; };
+
+        store.Reset();
+        for (uint32_t i = 0; i < cFrames; i++)
+        {
+            if (!store.Append(frame(i), delays[i]))
+            {
+                printf("%s: whip %d: out of memory at frame %u\n", path.c_str(), whip, i);
+                return false;
+            }
+        }
+
+        for (uint32_t i = 0; i < cFrames * 2; i++)
+        {
+            store.GetFrame(i % cFrames, rgb);
+            if (memcmp(rgb, frame(i % cFrames), cbFrame) != 0 ||
+                store.GetDelay(i % cFrames) != delays[i % cFrames])
+            {
+                printf("%s: whip %d frame %u doesn't match\n", path.c_str(), whip, i % cFrames);
+                exit(1);
+            }
+        }
+
+        cbRaw += (uint64_t)cFrames * cbFrame;
+        cbStored += store.BytesUsed();
+
+        nsSequential += benchTime(cFrames * 200, [&](uint32_t i)
+        {
+            store.GetFrame(i % cFrames, rgb);
+            benchKeep(rgb);
+        });
+
+        // worst case for random access is the frame before a keyframe
+        srand(whip);
+        nsRandom += benchTime(cFrames * 200, [&](uint32_t i)
+        {
+            store.GetFrame(rand() % cFrames, rgb);
+            benchKeep(rgb);
+        });
+    }
+    store.Reset();
+
+    nsSequential /= gif.height;
+    nsRandom /= gif.height;
+    printf("%-28s %5u %9llu %9llu %6.2fx %9.0f %9.0f\n",
+           path.substr(path.rfind('/') + 1).c_str(), cFrames,
+           (unsigned long long)cbRaw, (unsigned long long)cbStored,
+           (double)cbRaw / cbStored, nsSequential, nsRandom);
+
+    totals.cbRaw += cbRaw;
+    totals.cbStored += cbStored;
+    if (nsSequential > totals.nsSequentialMax)
+        totals.nsSequentialMax = nsSequential;
+    if (nsRandom > totals.nsRandomMax)
+        totals.nsRandomMax = nsRandom;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    std::string dir = argc > 1 ? argv[1] : GIF_DIR;
+
+    std::vector<std::string> files;
+    DIR *d = opendir(dir.c_str());
+    if (d)
+    {
+        struct dirent *e;
+        while ((e = readdir(d)) != NULL)
+        {
+            size_t len = strlen(e->d_name);
+            if (len > 4 && !strcmp(e->d_name + len - 4, ".gif"))
+                files.push_back(dir + "/" + e->d_name);
+        }
+        closedir(d);
+    }
+
+    printf("FrameStore: keyframe every %d frames, %d LEDs per whip\n", FRAMESTORE_KEYFRAME_INTERVAL, NUM_LEDS);
+    if (files.empty())
+    {
+        printf("no .gif files in %s\n", dir.c_str());
+        return 0;
+    }
+
+    std::sort(files.begin(), files.end());
+    printf("%-28s %5s %9s %9s %7s %9s %9s\n", "file (all whips)", "frames", "raw", "stored", "ratio", "seq ns", "random ns");
+
+    Totals totals;
+    for (const std::string &file : files)
+        benchFile(file, totals);
+
+    printf("\ntotal %.2fx: %llu bytes raw, %llu stored; GetFrame worst average %.0f ns in order, %.0f ns random\n",
+           (double)totals.cbRaw / totals.cbStored,
+           (unsigned long long)totals.cbRaw, (unsigned long long)totals.cbStored,
+           totals.nsSequentialMax, totals.nsRandomMax);
+    return 0;
+}
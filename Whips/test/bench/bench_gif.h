@@ -0,0 +1,291 @@
+#pragma once
+
+/*
+ * A small GIF decoder for the host benchmarks, so they can run on the
+ * repo's GIFs without AnimatedGIF. It composites every frame onto the
+ * canvas as the GIF89a spec describes (transparency, disposal methods 1-3,
+ * local color tables, interlacing) and keeps each one as RGB888, the way
+ * Gif.cpp and whipc see frames from AnimatedGIF's cooked draw mode. Row y
+ * of the canvas is whip y's strip.
+ *
+ * It's for measuring, not for shipping: it doesn't try to match
+ * AnimatedGIF's quirks, only to give the same kind of frames.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct BenchGif
+{
+    int width = 0;
+    int height = 0;
+    std::vector<uint16_t> delays; // per frame, in ms
+    std::vector<uint8_t> frames;  // whole canvases, height rows of width x 3 bytes
+};
+
+// Decodes one image's LZW data (the sub-blocks already joined) into cPixels
+// color indices. Returns false if the data is malformed or runs short.
+static bool benchGifLzw(const uint8_t *p, size_t cb, int minCodeSize, uint8_t *pOut, size_t cPixels)
+{
+    if (minCodeSize < 2 || minCodeSize > 8)
+        return false;
+
+    const int clear = 1 << minCodeSize;
+    const int end = clear + 1;
+    uint16_t rgPrefix[4096];
+    uint8_t rgSuffix[4096];
+    uint8_t rgStack[4097];
+
+    for (int i = 0; i < clear; i++)
+    {
+        rgPrefix[i] = 0xFFFF;
+        rgSuffix[i] = (uint8_t)i;
+    }
+
+    int codeSize = minCodeSize + 1;
+    int next = end + 1;
+    int prev = -1;
+    uint8_t first = 0;
+    uint32_t bits = 0;
+    int cBits = 0;
+    size_t iOut = 0;
+
+    for (size_t i = 0; iOut < cPixels;)
+    {
+        while (cBits < codeSize)
+        {
+            if (i >= cb)
+                return false;
+            bits |= (uint32_t)p[i++] << cBits;
+            cBits += 8;
+        }
+        int code = bits & ((1 << codeSize) - 1);
+        bits >>= codeSize;
+        cBits -= codeSize;
+
+        if (code == clear)
+        {
+            codeSize = minCodeSize + 1;
+            next = end + 1;
+            prev = -1;
+            continue;
+        }
+        if (code == end)
+            break;
+
+        int cur = code;
+        int cStack = 0;
+        if (prev < 0)
+        {
+            if (code >= clear)
+                return false;
+        }
+        else if (code >= next)
+        {
+            // KwKwK: the code being defined right now
+            if (code > next)
+                return false;
+            rgStack[cStack++] = first;
+            cur = prev;
+        }
+        while (cur >= clear)
+        {
+            rgStack[cStack++] = rgSuffix[cur];
+            cur = rgPrefix[cur];
+        }
+        first = (uint8_t)cur;
+        rgStack[cStack++] = first;
+
+        while (cStack > 0 && iOut < cPixels)
+            pOut[iOut++] = rgStack[--cStack];
+
+        if (prev >= 0 && next < 4096)
+        {
+            rgPrefix[next] = (uint16_t)prev;
+            rgSuffix[next] = first;
+            next++;
+            if (next == (1 << codeSize) && codeSize < 12)
+                codeSize++;
+        }
+        prev = code;
+    }
+
+    // a short image leaves the rest of its pixels at index 0
+    return true;
+}
+
+// Joins the data sub-blocks starting at data[i]; leaves i after the terminator
+static bool benchGifSubBlocks(const std::vector<uint8_t> &data, size_t &i, std::vector<uint8_t> *pOut)
+{
+    while (i < data.size())
+    {
+        uint8_t cb = data[i++];
+        if (cb == 0)
+            return true;
+        if (i + cb > data.size())
+            return false;
+        if (pOut)
+            pOut->insert(pOut->end(), &data[i], &data[i] + cb);
+        i += cb;
+    }
+    return false;
+}
+
+// Reads and decodes every frame of the GIF at path. Returns false if it
+// can't be read or isn't a GIF; a GIF that's cut short keeps the frames
+// before the damage.
+static bool benchLoadGif(const std::string &path, BenchGif &gif, size_t cFramesMax)
+{
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+
+    std::vector<uint8_t> data;
+    uint8_t buf[4096];
+    size_t cb;
+    while ((cb = fread(buf, 1, sizeof(buf), f)) > 0)
+        data.insert(data.end(), buf, buf + cb);
+    fclose(f);
+
+    if (data.size() < 13 || memcmp(data.data(), "GIF8", 4) != 0)
+        return false;
+
+    gif.width = data[6] | (data[7] << 8);
+    gif.height = data[8] | (data[9] << 8);
+    gif.delays.clear();
+    gif.frames.clear();
+
+    uint8_t rgGlobal[256 * 3] = {};
+    uint8_t bgIndex = data[11];
+    size_t i = 13;
+    if (data[10] & 0x80)
+    {
+        size_t cbTable = (2 << (data[10] & 0x07)) * 3;
+        if (i + cbTable > data.size())
+            return false;
+        memcpy(rgGlobal, &data[i], cbTable);
+        i += cbTable;
+    }
+
+    const size_t cbCanvas = (size_t)gif.width * gif.height * 3;
+    std::vector<uint8_t> canvas(cbCanvas, 0);
+    std::vector<uint8_t> saved;
+    std::vector<uint8_t> lzw;
+    std::vector<uint8_t> indices;
+
+    // from the last graphic control extension, for the next image
+    int disposal = 0;
+    int transparent = -1;
+    uint16_t delay = 0;
+
+    while (i < data.size() && gif.delays.size() < cFramesMax)
+    {
+        uint8_t block = data[i++];
+        if (block == 0x3B) // trailer
+            break;
+
+        if (block == 0x21) // extension
+        {
+            if (i >= data.size())
+                break;
+            uint8_t label = data[i++];
+            if (label == 0xF9 && i + 6 <= data.size() && data[i] == 4)
+            {
+                disposal = (data[i + 1] >> 2) & 0x07;
+                transparent = (data[i + 1] & 0x01) ? data[i + 4] : -1;
+                delay = (uint16_t)((data[i + 2] | (data[i + 3] << 8)) * 10);
+            }
+            if (!benchGifSubBlocks(data, i, nullptr))
+                break;
+            continue;
+        }
+
+        if (block != 0x2C || i + 9 > data.size()) // not an image: give up
+            break;
+
+        int left = data[i] | (data[i + 1] << 8);
+        int top = data[i + 2] | (data[i + 3] << 8);
+        int w = data[i + 4] | (data[i + 5] << 8);
+        int h = data[i + 6] | (data[i + 7] << 8);
+        uint8_t packed = data[i + 8];
+        i += 9;
+
+        const uint8_t *pTable = rgGlobal;
+        uint8_t rgLocal[256 * 3] = {};
+        if (packed & 0x80)
+        {
+            size_t cbTable = (2 << (packed & 0x07)) * 3;
+            if (i + cbTable > data.size())
+                break;
+            memcpy(rgLocal, &data[i], cbTable);
+            pTable = rgLocal;
+            i += cbTable;
+        }
+
+        if (i >= data.size())
+            break;
+        int minCodeSize = data[i++];
+        lzw.clear();
+        if (!benchGifSubBlocks(data, i, &lzw))
+            break;
+        indices.assign((size_t)w * h, 0);
+        if (!benchGifLzw(lzw.data(), lzw.size(), minCodeSize, indices.data(), indices.size()))
+            break;
+
+        if (disposal == 3)
+            saved = canvas;
+
+        // interlaced rows come in four passes
+        static const int rgStart[4] = {0, 4, 2, 1};
+        static const int rgStep[4] = {8, 8, 4, 2};
+        int pass = 0, y = 0;
+        for (int row = 0; row < h; row++)
+        {
+            int yCanvas = top + row;
+            if (packed & 0x40)
+            {
+                while (pass < 4 && rgStart[pass] + y * rgStep[pass] >= h)
+                {
+                    pass++;
+                    y = 0;
+                }
+                yCanvas = top + rgStart[pass] + y * rgStep[pass];
+                y++;
+            }
+            if (yCanvas >= gif.height)
+                continue;
+            for (int x = 0; x < w && left + x < gif.width; x++)
+            {
+                uint8_t ix = indices[(size_t)row * w + x];
+                if (ix == transparent)
+                    continue;
+                memcpy(&canvas[((size_t)yCanvas * gif.width + left + x) * 3], &pTable[ix * 3], 3);
+            }
+        }
+
+        gif.delays.push_back(delay);
+        gif.frames.insert(gif.frames.end(), canvas.begin(), canvas.end());
+
+        // leave the canvas as the next frame should start from it
+        if (disposal == 2)
+        {
+            for (int yc = top; yc < top + h && yc < gif.height; yc++)
+            {
+                for (int x = left; x < left + w && x < gif.width; x++)
+                    memcpy(&canvas[((size_t)yc * gif.width + x) * 3], &rgGlobal[bgIndex * 3], 3);
+            }
+        }
+        else if (disposal == 3)
+        {
+            canvas = saved;
+        }
+        disposal = 0;
+        transparent = -1;
+        delay = 0;
+    }
+
+    return !gif.delays.empty();
+}
@@ -0,0 +1,176 @@
+/*
+ * WS2812Serial::encode() before and after the lookup table encoder, in
+ * cycles per LED.
+ *
+ * The "before" encoder below is the PJRC loop the firmware used, kept here
+ * as a reference: a switch on the color order and a multiply per color for
+ * every LED, then 2 data bits per UART byte. Its WS2812_BGRW case sends
+ * blue twice, so that order is left out of the comparison.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "WS2812Serial.h"
+
+#ifndef NUM_LEDS
+#define NUM_LEDS 110
+#endif
+
+static void legacyEncode(uint8_t config, uint8_t brightness, const uint8_t *drawBuffer,
+                         uint8_t *frameBuffer, uint32_t numled)
+{
+    if (config < 6)
+    {
+        const uint8_t *p = drawBuffer;
+        const uint8_t *end = p + (numled * 3);
+        uint8_t *fb = frameBuffer;
+        while (p < end)
+        {
+            uint8_t b = *p++;
+            uint8_t g = *p++;
+            uint8_t r = *p++;
+            uint32_t mult = brightness + 1;
+            b = (b * mult) >> 8;
+            g = (g * mult) >> 8;
+            r = (r * mult) >> 8;
+            uint32_t n = 0;
+            switch (config)
+            {
+            case WS2812_RGB: n = (r << 16) | (g << 8) | b; break;
+            case WS2812_RBG: n = (r << 16) | (b << 8) | g; break;
+            case WS2812_GRB: n = (g << 16) | (r << 8) | b; break;
+            case WS2812_GBR: n = (g << 16) | (b << 8) | r; break;
+            case WS2812_BRG: n = (b << 16) | (r << 8) | g; break;
+            case WS2812_BGR: n = (b << 16) | (g << 8) | r; break;
+            }
+            const uint8_t *stop = fb + 12;
+            do
+            {
+                uint8_t x = 0x08;
+                if (!(n & 0x00800000)) x |= 0x07;
+                if (!(n & 0x00400000)) x |= 0xE0;
+                n <<= 2;
+                *fb++ = x;
+            } while (fb < stop);
+        }
+    }
+    else
+    {
+        const uint8_t *p = drawBuffer;
+        const uint8_t *end = p + (numled * 4);
+        uint8_t *fb = frameBuffer;
+        while (p < end)
+        {
+            uint8_t b = *p++;
+            uint8_t g = *p++;
+            uint8_t r = *p++;
+            uint8_t w = *p++;
+            uint32_t mult = brightness + 1;
+            b = (b * mult) >> 8;
+            g = (g * mult) >> 8;
+            r = (r * mult) >> 8;
+            w = (w * mult) >> 8;
+            uint32_t n = 0;
+            switch (config)
+            {
+            case WS2812_RGBW: n = (r << 24) | (g << 16) | (b << 8) | w; break;
+            case WS2812_RBGW: n = (r << 24) | (b << 16) | (g << 8) | w; break;
+            case WS2812_GRBW: n = (g << 24) | (r << 16) | (b << 8) | w; break;
+            case WS2812_GBRW: n = (g << 24) | (b << 16) | (r << 8) | w; break;
+            case WS2812_BRGW: n = (b << 24) | (r << 16) | (g << 8) | w; break;
+            case WS2812_BGRW: n = (b << 24) | (b << 16) | (r << 8) | w; break;
+            case WS2812_WRGB: n = (w << 24) | (r << 16) | (g << 8) | b; break;
+            case WS2812_WRBG: n = (w << 24) | (r << 16) | (b << 8) | g; break;
+            case WS2812_WGRB: n = (w << 24) | (g << 16) | (r << 8) | b; break;
+            case WS2812_WGBR: n = (w << 24) | (g << 16) | (b << 8) | r; break;
+            case WS2812_WBRG: n = (w << 24) | (b << 16) | (r << 8) | g; break;
+            case WS2812_WBGR: n = (w << 24) | (b << 16) | (g << 8) | r; break;
+            case WS2812_RWGB: n = (r << 24) | (w << 16) | (g << 8) | b; break;
+            case WS2812_RWBG: n = (r << 24) | (w << 16) | (b << 8) | g; break;
+            case WS2812_GWRB: n = (g << 24) | (w << 16) | (r << 8) | b; break;
+            case WS2812_GWBR: n = (g << 24) | (w << 16) | (b << 8) | r; break;
+            case WS2812_BWRG: n = (b << 24) | (w << 16) | (r << 8) | g; break;
+            case WS2812_BWGR: n = (b << 24) | (w << 16) | (g << 8) | r; break;
+            case WS2812_RGWB: n = (r << 24) | (g << 16) | (w << 8) | b; break;
+            case WS2812_RBWG: n = (r << 24) | (b << 16) | (w << 8) | g; break;
+            case WS2812_GRWB: n = (g << 24) | (r << 16) | (w << 8) | b; break;
+            case WS2812_GBWR: n = (g << 24) | (b << 16) | (w << 8) | r; break;
+            case WS2812_BRWG: n = (b << 24) | (r << 16) | (w << 8) | g; break;
+            case WS2812_BGWR: n = (b << 24) | (g << 16) | (w << 8) | r; break;
+            }
+            const uint8_t *stop = fb + 16;
+            do
+            {
+                uint8_t x = 0x08;
+                if (!(n & 0x80000000)) x |= 0x07;
+                if (!(n & 0x40000000)) x |= 0xE0;
+                n <<= 2;
+                *fb++ = x;
+            } while (fb < stop);
+        }
+    }
+}
+
+// cycles per LED of fn() over NUM_LEDS, best of a few runs
+template <typename F>
+static double cyclesPerLed(uint32_t iterations, F fn)
+{
+    double best = 1e30;
+    for (int trial = 0; trial < 5; trial++)
+    {
+        uint64_t start = benchCycles();
+        for (uint32_t i = 0; i < iterations; i++)
+            fn(i);
+        double cycles = (double)(benchCycles() - start) / ((double)NUM_LEDS * iterations);
+        if (cycles < best)
+            best = cycles;
+    }
+    return best;
+}
+
+int main()
+{
+    static uint8_t drawBuffer[NUM_LEDS * 4];
+    static uint8_t legacyFrame[NUM_LEDS * 16];
+    static uint8_t frameBuffer[NUM_LEDS * 16];
+    for (size_t i = 0; i < sizeof(drawBuffer); i++)
+        drawBuffer[i] = (uint8_t)rand();
+
+    // Same bytes as before for every color order and brightness
+    for (uint8_t config = 0; config < 30; config++)
+    {
+        if (config == WS2812_BGRW)
+            continue;
+        WS2812Serial strip(NUM_LEDS, frameBuffer, drawBuffer, 1, config);
+        for (int brightness = 0; brightness < 256; brightness++)
+        {
+            strip.setBrightness(brightness);
+            strip.encode();
+            legacyEncode(config, brightness, drawBuffer, legacyFrame, NUM_LEDS);
+            if (memcmp(legacyFrame, frameBuffer, strip.encodedBytes()) != 0)
+            {
+                printf("MISMATCH for config %d at brightness %d\n", config, brightness);
+                return 1;
+            }
+        }
+    }
+    printf("table encoder matches the PJRC loop for every color order and brightness\n");
+
+    const uint8_t configs[] = {WS2812_BGR, WS2812_GRBW};
+    const char *names[] = {"BGR ", "GRBW"};
+    for (int i = 0; i < 2; i++)
+    {
+        WS2812Serial strip(NUM_LEDS, frameBuffer, drawBuffer, 1, configs[i]);
+        strip.setBrightness(128);
+        double cLegacy = cyclesPerLed(20000, [&](uint32_t)
+                                      { legacyEncode(configs[i], 128, drawBuffer, legacyFrame, NUM_LEDS); benchKeep(legacyFrame); });
+        double cTable = cyclesPerLed(20000, [&](uint32_t)
+                                     { strip.encode(); benchKeep(frameBuffer); });
+        printf("%s x %d LEDs   before %6.1f cycles/LED   after %6.1f cycles/LED (%.1fx)\n",
+               names[i], NUM_LEDS, cLegacy, cTable, cLegacy / cTable);
+    }
+
+    return 0;
+}
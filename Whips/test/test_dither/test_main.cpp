@@ -0,0 +1,157 @@
+/*
+ * Temporal dithering accuracy. Runs on the host:
+ *
+ *     pio test -e native -f test_dither
+ *
+ * Renders a frame of every color value over a run of refreshes at each of
+ * the dim brightness levels the DOM uses, and measures how far each LED's
+ * average intensity is from what it should be (ColorLut's exact light out),
+ * against the error of ColorLut's 8-bit table on its own.
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+#include <unity.h>
+
+#include "ColorLut.h"
+#include "Dither.h"
+
+// about 1/4 s of refreshes between frames of a still image
+#define DITHER_REFRESHES 64
+
+// LedShow::rgBrightness below LED_DITHER_BRIGHTNESS
+static const uint8_t rgBrightness[] = {1, 2, 3, 4, 6, 8, 10, 13, 16, 21, 26, 34, 42, 55};
+
+static CRGB content[NUM_LEDS];
+static CRGB out[NUM_LEDS];
+
+static void makeContent()
+{
+    uint8_t *pb = (uint8_t *)content;
+    for (int i = 0; i < NUM_LEDS * 3; i++)
+        pb[i] = (uint8_t)(i * 37 + 11);
+}
+
+// worst and mean |average - ideal| over every color of the next
+// DITHER_REFRESHES refreshes, in 8-bit steps
+static void measure(uint8_t brightness, double &errMax, double &errMean)
+{
+    static uint32_t rgSum[NUM_LEDS * 3];
+    memset(rgSum, 0, sizeof(rgSum));
+
+    ColorLut::SetBrightness(brightness);
+    for (int n = 0; n < DITHER_REFRESHES; n++)
+    {
+        Dither::Render(out);
+        const uint8_t *pb = (const uint8_t *)out;
+        for (int i = 0; i < NUM_LEDS * 3; i++)
+            rgSum[i] += pb[i];
+    }
+
+    const uint8_t *pbContent = (const uint8_t *)content;
+    errMax = 0;
+    errMean = 0;
+    for (int i = 0; i < NUM_LEDS * 3; i++)
+    {
+        double ideal = ColorLut::Exact(i % 3)[pbContent[i]] / 256.0;
+        double err = fabs((double)rgSum[i] / DITHER_REFRESHES - ideal);
+        if (err > errMax)
+            errMax = err;
+        errMean += err;
+    }
+    errMean /= NUM_LEDS * 3;
+}
+
+// the same for ColorLut::Apply(), which shows the same value every refresh
+static void measureRounded(uint8_t brightness, double &errMax, double &errMean)
+{
+    ColorLut::SetBrightness(brightness);
+    ColorLut::Apply(content, out);
+    const uint8_t *pbContent = (const uint8_t *)content;
+    const uint8_t *pb = (const uint8_t *)out;
+    errMax = 0;
+    errMean = 0;
+    for (int i = 0; i < NUM_LEDS * 3; i++)
+    {
+        double ideal = ColorLut::Exact(i % 3)[pbContent[i]] / 256.0;
+        double err = fabs(ideal - pb[i]);
+        if (err > errMax)
+            errMax = err;
+        errMean += err;
+    }
+    errMean /= NUM_LEDS * 3;
+}
+
+void test_dither_average_error(void)
+{
+    char msg[160];
+    for (uint8_t brightness : rgBrightness)
+    {
+        double errMax, errMean, errMaxRounded, errMeanRounded;
+        Dither::SetFrame(content);
+        measure(brightness, errMax, errMean);
+        measureRounded(brightness, errMaxRounded, errMeanRounded);
+
+        snprintf(msg, sizeof(msg), "brightness %3d: mean error %.4f (max %.4f), 8-bit table %.4f (max %.4f)",
+                 brightness, errMean, errMax, errMeanRounded, errMaxRounded);
+        TEST_MESSAGE(msg);
+
+        // what's carried from one refresh to the next is under one step,
+        // so the average can't be off by more than one step over the run
+        if (errMax >= 1.0 / DITHER_REFRESHES)
+            TEST_FAIL_MESSAGE(msg);
+        if (errMean >= errMeanRounded)
+            TEST_FAIL_MESSAGE(msg);
+    }
+}
+
+void test_dither_whole_values_are_exact(void)
+{
+    // off and full come through gamma as they are, so never flicker
+    static CRGB onOff[NUM_LEDS];
+    for (int i = 0; i < NUM_LEDS; i++)
+        onOff[i] = (i & 1) ? CRGB(255, 0, 255) : CRGB(0, 255, 0);
+
+    ColorLut::SetBrightness(255);
+    Dither::SetFrame(onOff);
+    for (int n = 0; n < 4; n++)
+    {
+        Dither::Render(out);
+        if (memcmp(out, onOff, sizeof(onOff)) != 0)
+            TEST_FAIL_MESSAGE("brightness 255 changed 0 or 255");
+    }
+}
+
+void test_dither_follows_brightness(void)
+{
+    // a change of brightness with no new frame still converges on it
+    char msg[160];
+    double errMax, errMean;
+    Dither::SetFrame(content);
+    measure(4, errMax, errMean);
+    measure(21, errMax, errMean);
+    snprintf(msg, sizeof(msg), "after 4 -> 21: max error %.4f", errMax);
+    if (errMax >= 1.0 / DITHER_REFRESHES)
+        TEST_FAIL_MESSAGE(msg);
+    TEST_MESSAGE(msg);
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+int main()
+{
+    makeContent();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_dither_average_error);
+    RUN_TEST(test_dither_whole_values_are_exact);
+    RUN_TEST(test_dither_follows_brightness);
+    return UNITY_END();
+}
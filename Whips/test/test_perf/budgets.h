@@ -0,0 +1,42 @@
+#pragma once
+
+/*
+ * Recorded budgets for test_perf, in reference units: a path's time divided
+ * by the time of referenceWorkload() in the same run (see test_main.cpp).
+ *
+ * To re-record after an intentional change:
+ *     WHIPS_PERF_RECORD=1 pio test -e native -f test_perf -v
+ * and paste the printed #define lines here. A budget of 0 means "not
+ * recorded yet"; that test reports its measurement and is ignored, so a
+ * clean tree passes until someone records it.
+ */
+
+// how far past its budget a path may go before the test fails
+#ifndef PERF_TOLERANCE
+#define PERF_TOLERANCE 1.50
+#endif
+
+// one 110-LED column, analytic span renderer (what a SUB runs per 'f' packet)
+#define BUDGET_FLAPPY_COLUMN 0.07025
+
+// one column, 4x4 supersampling reference renderer
+#define BUDGET_FLAPPY_COLUMN_SUPERSAMPLED 0.4356
+
+// the whole 24x110 frame (visualizer / monitor)
+#define BUDGET_FLAPPY_STATE 9.875
+
+// checksum verification of a cmdFlappyState packet (Checksum::Verify)
+#define BUDGET_CRC_CHECK 0.003264
+
+// WS2812Serial::encode() for one whip
+#define BUDGET_WS2812_ENCODE 0.01817
+
+// one dbgprintf with %s, %d and %x
+#define BUDGET_DBGPRINTF 0.01628
+
+// Gif::LoadGif per KB of GIF file, decoded by the real AnimatedGIF library
+// at the version pinned in the native env's lib_deps, from the
+// Whips-Art/Hex/experiment GIFs. Not recorded yet, so test_gif_load is
+// ignored until it is; record it from the Whips directory so PERF_GIF_DIR
+// is found, and again whenever the pin moves.
+#define BUDGET_GIF_LOAD_PER_KB 0
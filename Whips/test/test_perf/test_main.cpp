@@ -0,0 +1,349 @@
+/*
+ * Performance regression suite for the hot paths. Runs on the host:
+ *
+ *     pio test -e native -f test_perf
+ *
+ * Each path is timed and divided by the time of a fixed reference workload
+ * measured in the same run, so the budgets in budgets.h carry from one
+ * machine to another. A test fails when a path costs more than its budget
+ * times PERF_TOLERANCE.
+ *
+ * After an intentional change, run with WHIPS_PERF_RECORD=1 to print fresh
+ * budget lines for budgets.h instead of checking.
+ */
+
+#include <Arduino.h>
+#include <SD.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <unity.h>
+
+#include "Util.h"
+#include "Gif.h"
+#include "Commands.h"
+#include "Checksum.h"
+#include "FlappyRender.h"
+#include "WS2812Serial.h"
+
+#include "budgets.h"
+
+#define PERF_TRIALS 7
+#define PERF_STATES 64
+
+#ifndef PERF_GIF_DIR
+#define PERF_GIF_DIR "../Whips-Art/Hex/experiment"
+#endif
+
+static bool recording = false;
+static double referenceNanos = 0;
+
+static uint64_t nanosNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Keeps the optimizer from discarding a result
+static inline void keep(const void *p)
+{
+    __asm__ __volatile__("" : : "g"(p) : "memory");
+}
+
+// Best of PERF_TRIALS runs of fn() called iterations times; nanoseconds per call
+template <typename F>
+static double timeNanos(uint32_t iterations, F fn)
+{
+    double best = 0;
+    for (int trial = 0; trial < PERF_TRIALS; trial++)
+    {
+        uint64_t start = nanosNow();
+        for (uint32_t i = 0; i < iterations; i++)
+            fn(i);
+        double each = (double)(nanosNow() - start) / iterations;
+        if (trial == 0 || each < best)
+            best = each;
+    }
+    return best;
+}
+
+// The yardstick: byte loads, table lookups, multiplies and branches over a
+// cache-resident buffer, roughly the mix the firmware's hot paths use.
+static uint32_t referenceWorkload()
+{
+    static uint8_t buf[4096];
+    static uint16_t table[256];
+    static bool init = false;
+    if (!init)
+    {
+        for (int i = 0; i < 4096; i++)
+            buf[i] = (uint8_t)(i * 131 + 7);
+        for (int i = 0; i < 256; i++)
+            table[i] = (uint16_t)(i * 40503u);
+        init = true;
+    }
+
+    uint32_t h = 0;
+    for (int i = 0; i < 4096; i++)
+    {
+        uint8_t b = buf[i];
+        h = (h << 5) ^ (h >> 27) ^ table[b ^ (h & 0xFF)];
+        if (b & 0x80)
+            h += b * 3;
+    }
+    return h;
+}
+
+static void check(const char *name, double nanos, double budget)
+{
+    double units = nanos / referenceNanos;
+    char msg[160];
+
+    if (recording)
+    {
+        snprintf(msg, sizeof(msg), "#define %s %.4g", name, units);
+        TEST_MESSAGE(msg);
+        return;
+    }
+
+    if (budget <= 0)
+    {
+        snprintf(msg, sizeof(msg), "%s not recorded yet (measured %.4g, %.0f ns); record it with WHIPS_PERF_RECORD=1",
+                 name, units, nanos);
+        TEST_IGNORE_MESSAGE(msg);
+    }
+
+    snprintf(msg, sizeof(msg), "%s: %.4g units (%.0f ns), budget %.4g x %.2f",
+             name, units, nanos, budget, PERF_TOLERANCE);
+    if (units > budget * PERF_TOLERANCE)
+        TEST_FAIL_MESSAGE(msg);
+    TEST_MESSAGE(msg);
+}
+
+//
+// Flappy rendering
+//
+
+struct FlappyArgs
+{
+    uint8_t gameState;
+    uint16_t birdY;
+    uint16_t score;
+    int16_t pipeX[3];
+    uint16_t pipeGapY[3];
+    int16_t scrollX;
+    uint8_t flashWhip;
+};
+
+static FlappyArgs flappyStates[PERF_STATES];
+
+// Three quarters of the states are mid-game, the rest are the game-over scroller
+static void makeFlappyStates()
+{
+    srand(2026);
+    for (int i = 0; i < PERF_STATES; i++)
+    {
+        FlappyArgs &a = flappyStates[i];
+        a.gameState = (i % 4 == 3) ? FLAPPY_STATE_GAMEOVER : FLAPPY_STATE_PLAYING;
+        a.birdY = rand() % FLAPPY_VIRTUAL_HEIGHT;
+        a.score = rand() % 200;
+        for (int p = 0; p < 3; p++)
+        {
+            a.pipeX[p] = (int16_t)(rand() % 120 - 12);
+            a.pipeGapY[p] = 60 + rand() % 320;
+        }
+        a.scrollX = rand() % 260 - 140;
+        a.flashWhip = 255;
+    }
+}
+
+void test_flappy_column(void)
+{
+    uint8_t out[NUM_LEDS * 3];
+    double nanos = timeNanos(PERF_STATES * FLAPPY_PHYSICAL_WIDTH * 8, [&](uint32_t i)
+    {
+        const FlappyArgs &a = flappyStates[(i / FLAPPY_PHYSICAL_WIDTH) % PERF_STATES];
+        renderFlappyColumnSpans(i % FLAPPY_PHYSICAL_WIDTH, a.gameState, a.birdY, a.score,
+                                a.pipeX[0], a.pipeGapY[0], a.pipeX[1], a.pipeGapY[1],
+                                a.pipeX[2], a.pipeGapY[2], a.scrollX, a.flashWhip, out);
+        keep(out);
+    });
+    check("BUDGET_FLAPPY_COLUMN", nanos, BUDGET_FLAPPY_COLUMN);
+}
+
+void test_flappy_column_supersampled(void)
+{
+    uint8_t out[NUM_LEDS * 3];
+    double nanos = timeNanos(PERF_STATES * FLAPPY_PHYSICAL_WIDTH, [&](uint32_t i)
+    {
+        const FlappyArgs &a = flappyStates[(i / FLAPPY_PHYSICAL_WIDTH) % PERF_STATES];
+        renderFlappyColumn(i % FLAPPY_PHYSICAL_WIDTH, a.gameState, a.birdY, a.score,
+                           a.pipeX[0], a.pipeGapY[0], a.pipeX[1], a.pipeGapY[1],
+                           a.pipeX[2], a.pipeGapY[2], a.scrollX, a.flashWhip, out);
+        keep(out);
+    });
+    check("BUDGET_FLAPPY_COLUMN_SUPERSAMPLED", nanos, BUDGET_FLAPPY_COLUMN_SUPERSAMPLED);
+}
+
+void test_flappy_state(void)
+{
+    static uint8_t out[FLAPPY_PHYSICAL_WIDTH * FLAPPY_PHYSICAL_HEIGHT * 3];
+    double nanos = timeNanos(PERF_STATES, [&](uint32_t i)
+    {
+        const FlappyArgs &a = flappyStates[i % PERF_STATES];
+        renderFlappyState(a.gameState, a.birdY, a.score,
+                          a.pipeX[0], a.pipeGapY[0], a.pipeX[1], a.pipeGapY[1],
+                          a.pipeX[2], a.pipeGapY[2], a.scrollX, a.flashWhip, out);
+        keep(out);
+    });
+    check("BUDGET_FLAPPY_STATE", nanos, BUDGET_FLAPPY_STATE);
+}
+
+//
+// Packet checksum, done the way Led::onPacketReceived does it
+//
+
+// robtillaart/CRC's calcCRC16() with its defaults (polynomial 0x8001, no
+// reflection, masks 0), a bit at a time: what the DOM used to send
+static uint16_t referenceCrc16(const uint8_t *pb, size_t cb)
+{
+    uint16_t crc = 0;
+    while (cb--)
+    {
+        crc ^= (uint16_t)*pb++ << 8;
+        for (int i = 0; i < 8; i++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x8001 : crc << 1;
+    }
+    return crc;
+}
+
+void test_crc_check(void)
+{
+    cmdFlappyState cmd;
+    cmd.gameState = cmdFlappyState::STATE_PLAYING;
+    cmd.pipe1X = 40;
+    cmd.pipe1GapY = 200;
+    Checksum::Stamp((uint8_t *)&cmd, sizeof(cmd));
+
+    uint8_t packet[sizeof(cmd)];
+    memcpy(packet, &cmd, sizeof(cmd));
+
+    // still the checksum the DOM used to send
+    uint16_t checksum = cmd.checksum;
+    cmd.checksum = 0;
+    TEST_ASSERT_EQUAL_UINT16(referenceCrc16((uint8_t *)&cmd, sizeof(cmd)), checksum);
+
+    uint32_t failures = 0;
+    double nanos = timeNanos(20000, [&](uint32_t)
+    {
+        if (!Checksum::Verify(packet, sizeof(packet)))
+            failures++;
+        keep(packet);
+    });
+
+    TEST_ASSERT_EQUAL_UINT32(0, failures);
+    check("BUDGET_CRC_CHECK", nanos, BUDGET_CRC_CHECK);
+}
+
+//
+// WS2812Serial bit expansion for one whip
+//
+
+void test_ws2812_encode(void)
+{
+    static uint8_t drawBuffer[NUM_LEDS * 3];
+    static uint8_t frameBuffer[NUM_LEDS * 12];
+    for (size_t i = 0; i < sizeof(drawBuffer); i++)
+        drawBuffer[i] = (uint8_t)(i * 37 + 11);
+
+    WS2812Serial strip(NUM_LEDS, frameBuffer, drawBuffer, 1, WS2812_RGB);
+    strip.setBrightness(128);
+
+    double nanos = timeNanos(4000, [&](uint32_t)
+    {
+        strip.encode();
+        keep(frameBuffer);
+    });
+    check("BUDGET_WS2812_ENCODE", nanos, BUDGET_WS2812_ENCODE);
+}
+
+//
+// Debug formatting (output goes nowhere here, so this is the formatter alone)
+//
+
+void test_dbgprintf(void)
+{
+    double nanos = timeNanos(20000, [&](uint32_t i)
+    {
+        dbgprintf("Reading GIF %s took %d millis (%x)\n", "/003.gif", (int)i, (int)i);
+    });
+    check("BUDGET_DBGPRINTF", nanos, BUDGET_DBGPRINTF);
+}
+
+//
+// GIF decode: time per KB of GIF, over every GIF in PERF_GIF_DIR
+//
+
+void test_gif_load(void)
+{
+    SD.setRoot(PERF_GIF_DIR);
+    if (!SD.begin(0))
+        TEST_IGNORE_MESSAGE("no GIF directory at " PERF_GIF_DIR);
+
+    uint16_t gifs[32];
+    uint32_t cGifs = 0;
+    uint32_t totalBytes = 0;
+    char rgchFileName[12];
+    for (uint16_t n = 1; n < 1000 && cGifs < 32; n++)
+    {
+        sprintf(rgchFileName, "/%03d.gif", n);
+        File f = SD.open(rgchFileName);
+        if (!f)
+            continue;
+        totalBytes += f.size();
+        f.close();
+        gifs[cGifs++] = n;
+    }
+    if (cGifs == 0)
+        TEST_IGNORE_MESSAGE("no GIFs in " PERF_GIF_DIR);
+
+    Gif::setup();
+    double nanos = timeNanos(1, [&](uint32_t)
+    {
+        for (uint32_t g = 0; g < cGifs; g++)
+            Gif::LoadGif(gifs[g]);
+    });
+    check("BUDGET_GIF_LOAD_PER_KB", nanos * 1024 / totalBytes, BUDGET_GIF_LOAD_PER_KB);
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+int main()
+{
+    const char *record = getenv("WHIPS_PERF_RECORD");
+    recording = record && *record && *record != '0';
+
+    makeFlappyStates();
+    referenceNanos = timeNanos(2000, [](uint32_t)
+    {
+        uint32_t h = referenceWorkload();
+        keep(&h);
+    });
+
+    UNITY_BEGIN();
+    RUN_TEST(test_flappy_column);
+    RUN_TEST(test_flappy_column_supersampled);
+    RUN_TEST(test_flappy_state);
+    RUN_TEST(test_crc_check);
+    RUN_TEST(test_ws2812_encode);
+    RUN_TEST(test_dbgprintf);
+    RUN_TEST(test_gif_load);
+    return UNITY_END();
+}
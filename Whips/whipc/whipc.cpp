@@ -0,0 +1,225 @@
+/*
+ * whipc - compiles animated GIFs into pre-sliced .whp animation files
+ *
+ *     whipc [-o outdir] 001.gif 002.gif ...
+ *
+ * Decodes every frame of each GIF with the same AnimatedGIF settings the
+ * firmware uses (RGB888, cooked), cuts each frame into one strip per whip
+ * (GIF row y = whip y), and writes NNN.whp next to NNN.gif, or into outdir.
+ * Copy the .whp files to the SD card alongside the GIFs; a SUB loads its
+ * strip from the .whp and only falls back to decoding the GIF if there
+ * isn't one. The format is described in src/AnimationFile.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <AnimatedGIF.h>
+#include "AnimationFile.h"
+
+struct Canvas
+{
+    int width;
+    int height;
+    std::vector<uint8_t> rgb; // height rows of width x 3 bytes
+};
+
+//
+// AnimatedGIF callbacks, stdio versions of the ones in Gif.cpp
+//
+
+static void *openFile(const char *fname, int32_t *pSize)
+{
+    FILE *f = fopen(fname, "rb");
+    if (f)
+    {
+        fseek(f, 0, SEEK_END);
+        *pSize = (int32_t)ftell(f);
+        fseek(f, 0, SEEK_SET);
+    }
+    return f;
+}
+
+static void closeFile(void *pHandle)
+{
+    if (pHandle)
+        fclose((FILE *)pHandle);
+}
+
+static int32_t readFile(GIFFILE *pFile, uint8_t *pBuf, int32_t iLen)
+{
+    int32_t iBytesRead = iLen;
+    // same short read at the end of the file as Gif::GIFReadFile, so both
+    // decoders see exactly the same bytes
+    if ((pFile->iSize - pFile->iPos) < iLen)
+        iBytesRead = pFile->iSize - pFile->iPos - 1;
+    if (iBytesRead <= 0)
+        return 0;
+    iBytesRead = (int32_t)fread(pBuf, 1, iBytesRead, (FILE *)pFile->fHandle);
+    pFile->iPos = (int32_t)ftell((FILE *)pFile->fHandle);
+    return iBytesRead;
+}
+
+static int32_t seekFile(GIFFILE *pFile, int32_t iPosition)
+{
+    fseek((FILE *)pFile->fHandle, iPosition, SEEK_SET);
+    pFile->iPos = (int32_t)ftell((FILE *)pFile->fHandle);
+    return pFile->iPos;
+}
+
+// like Gif::GIFDraw, but keeps every row instead of just one whip's
+static void drawLine(GIFDRAW *pDraw)
+{
+    Canvas *canvas = (Canvas *)pDraw->pUser;
+    if (pDraw->y < 0 || pDraw->y >= canvas->height)
+        return;
+    memcpy(&canvas->rgb[(size_t)pDraw->y * canvas->width * 3], pDraw->pPixels, canvas->width * 3);
+}
+
+static void *allocFrame(uint32_t u32Size)
+{
+    return malloc(u32Size);
+}
+
+static void freeFrame(void *p)
+{
+    free(p);
+}
+
+static std::string outputPath(const std::string &gifPath, const char *outDir)
+{
+    std::string name = gifPath;
+    size_t dot = name.rfind('.');
+    if (dot != std::string::npos && name.find('/', dot) == std::string::npos)
+        name.erase(dot);
+    name += ".whp";
+
+    if (!outDir)
+        return name;
+
+    size_t slash = name.rfind('/');
+    if (slash != std::string::npos)
+        name.erase(0, slash + 1);
+    return std::string(outDir) + "/" + name;
+}
+
+static bool compile(AnimatedGIF &gif, const std::string &gifPath, const std::string &whpPath)
+{
+    if (!gif.open(gifPath.c_str(), openFile, closeFile, readFile, seekFile, drawLine))
+    {
+        fprintf(stderr, "%s: can't open (error %d)\n", gifPath.c_str(), gif.getLastError());
+        return false;
+    }
+
+    Canvas canvas;
+    canvas.width = gif.getCanvasWidth();
+    canvas.height = gif.getCanvasHeight();
+    canvas.rgb.assign((size_t)canvas.width * canvas.height * 3, 0);
+
+    if (gif.allocFrameBuf(allocFrame) != GIF_SUCCESS)
+    {
+        fprintf(stderr, "%s: out of memory\n", gifPath.c_str());
+        gif.close();
+        return false;
+    }
+    gif.setDrawType(GIF_DRAW_COOKED);
+
+    std::vector<uint16_t> delays;
+    std::vector<uint8_t> frames; // cFrames whole canvases, one after another
+
+    int more;
+    do
+    {
+        int iDelay = 0;
+        more = gif.playFrame(false, &iDelay, &canvas);
+        if (more < 0)
+        {
+            fprintf(stderr, "%s: decode error %d after %d frames\n", gifPath.c_str(), gif.getLastError(), (int)delays.size());
+            break;
+        }
+        delays.push_back((uint16_t)iDelay);
+        frames.insert(frames.end(), canvas.rgb.begin(), canvas.rgb.end());
+    } while (more && delays.size() < 0xFFFF);
+
+    gif.freeFrameBuf(freeFrame);
+    gif.close();
+
+    if (delays.empty())
+        return false;
+
+    AnimationFile::Header hdr;
+    hdr.magic = AnimationFile::MAGIC;
+    hdr.version = AnimationFile::VERSION;
+    hdr.cWhips = (uint16_t)canvas.height;
+    hdr.cLeds = (uint16_t)canvas.width;
+    hdr.cFrames = (uint16_t)delays.size();
+
+    FILE *out = fopen(whpPath.c_str(), "wb");
+    if (!out)
+    {
+        perror(whpPath.c_str());
+        return false;
+    }
+
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, out) == 1 &&
+              fwrite(delays.data(), sizeof(uint16_t), delays.size(), out) == delays.size();
+
+    // transpose: all of whip 0's frames, then all of whip 1's, ...
+    size_t cbRow = AnimationFile::FrameBytes(hdr);
+    size_t cbCanvas = cbRow * hdr.cWhips;
+    for (uint16_t whip = 0; ok && whip < hdr.cWhips; whip++)
+    {
+        for (uint16_t frame = 0; ok && frame < hdr.cFrames; frame++)
+            ok = fwrite(&frames[frame * cbCanvas + whip * cbRow], 1, cbRow, out) == cbRow;
+    }
+
+    if (fclose(out) != 0 || !ok)
+    {
+        fprintf(stderr, "%s: write failed\n", whpPath.c_str());
+        return false;
+    }
+
+    printf("%s -> %s: %d x %d, %d frames, %u bytes per whip\n",
+           gifPath.c_str(), whpPath.c_str(), hdr.cLeds, hdr.cWhips, hdr.cFrames,
+           (unsigned)(hdr.cFrames * cbRow));
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const char *outDir = NULL;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            outDir = argv[++i];
+        else if (argv[i][0] == '-')
+        {
+            fprintf(stderr, "usage: %s [-o outdir] file.gif ...\n", argv[0]);
+            return 2;
+        }
+        else
+            inputs.push_back(argv[i]);
+    }
+
+    if (inputs.empty())
+    {
+        fprintf(stderr, "usage: %s [-o outdir] file.gif ...\n", argv[0]);
+        return 2;
+    }
+
+    AnimatedGIF gif;
+    gif.begin(GIF_PALETTE_RGB888);
+
+    int failures = 0;
+    for (const std::string &input : inputs)
+    {
+        if (!compile(gif, input, outputPath(input, outDir)))
+            failures++;
+    }
+    return failures ? 1 : 0;
+}